@@ -4,6 +4,11 @@
 #include "Breakable/BreakableActor.h"
 #include "GeometryCollection/GeometryCollectionComponent.h"
 #include "Items/Treasure.h"
+#include "Items/PickupPoolSubsystem.h"
+#include "Items/LootRegistrySubsystem.h"
+#include "Items/LootTable.h"
+#include "Items/LootTableSubsystem.h"
+#include "Breakable/BreakableDebrisSubsystem.h"
 #include "Components/CapsuleComponent.h"
 
 // Sets default values
@@ -29,7 +34,11 @@ ABreakableActor::ABreakableActor()
 // Called when the game starts or when spawned
 void ABreakableActor::BeginPlay(){
 	Super::BeginPlay();
-	
+
+	// Has the treasure resident by the time this gets hit, the level load never waits on it
+	if (ULootTableSubsystem* LootTables = GetWorld()->GetSubsystem<ULootTableSubsystem>()) {
+		LootTables->LoadLoot(GetLootClasses());
+	}
 }
 
 // Called every frame
@@ -42,11 +51,43 @@ void ABreakableActor::GetHit_Implementation(const FVector& ImpactPoint, AActor*
 	if(bBroken) { return; }
 	bBroken = true;
 	UWorld* World = GetWorld();
-	if (World && TreasureClasses.Num() > 0) {
-		FVector Location = GetActorLocation();
-		Location.Z += 75.f;
-		World->SpawnActor<ATreasure>(TreasureClasses[FMath::RandRange(0, TreasureClasses.Num() - 1)], Location, GetActorRotation());
+	// Once it shatters the fragments are the debris budget's to sleep, fade and clean up
+	UBreakableDebrisSubsystem* DebrisBudget = World ? World->GetSubsystem<UBreakableDebrisSubsystem>() : nullptr;
+	if (DebrisBudget && DebrisBudget->IsBudgetEnabled()) {
+		DebrisBudget->RegisterDebris(this);
+	}
+	const TArray<TSoftClassPtr<ATreasure>>& LootClasses = GetLootClasses();
+	ULootTableSubsystem* LootTables = World ? World->GetSubsystem<ULootTableSubsystem>() : nullptr;
+	if (LootTables && LootClasses.Num() > 0) {
+		if (const TSubclassOf<ATreasure> TreasureClass = LootTables->PickResidentTreasure(LootClasses)) {
+			SpawnTreasure(TreasureClass);
+		} else {
+			// Broken before any of its loot finished loading, drop it once it has rather than block here
+			LootTables->LoadLoot(LootClasses, FStreamableDelegate::CreateWeakLambda(this, [this]() {
+				ULootTableSubsystem* LoadedLootTables = GetWorld() ? GetWorld()->GetSubsystem<ULootTableSubsystem>() : nullptr;
+				if (LoadedLootTables == nullptr) { return; }
+				if (const TSubclassOf<ATreasure> TreasureClass = LoadedLootTables->PickResidentTreasure(GetLootClasses())) {
+					SpawnTreasure(TreasureClass);
+				}
+			}));
+		}
 		Capsule->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Ignore);
 	}
 }
 
+const TArray<TSoftClassPtr<ATreasure>>& ABreakableActor::GetLootClasses() const {
+	return LootTable ? LootTable->TreasureClasses : TreasureClasses;
+}
+
+void ABreakableActor::SpawnTreasure(TSubclassOf<ATreasure> TreasureClass) {
+	UWorld* World = GetWorld();
+	FVector Location = GetActorLocation();
+	Location.Z += 75.f;
+	if (ULootRegistrySubsystem* LootRegistry = World->GetSubsystem<ULootRegistrySubsystem>()) {
+		LootRegistry->DropLoot(TreasureClass, FTransform(GetActorRotation(), Location));
+	} else if (UPickupPoolSubsystem* PickupPool = World->GetSubsystem<UPickupPoolSubsystem>()) {
+		PickupPool->SpawnPickup<ATreasure>(TreasureClass, Location, GetActorRotation());
+	} else {
+		World->SpawnActor<ATreasure>(TreasureClass, Location, GetActorRotation());
+	}
+}
@@ -0,0 +1,198 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Breakable/BreakableDebrisSubsystem.h"
+#include "Breakable/BreakableActor.h"
+#include "GeometryCollection/GeometryCollectionComponent.h"
+#include "GeometryCollection/GeometryCollectionObject.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsEngine/PhysicsObjectExternalInterface.h"
+#include "Slash/SlashStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Breakable Debris"), STAT_SlashBreakableDebris, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Debris Fragments Live"), STAT_SlashDebrisFragmentsLive, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Debris Fragments Awake"), STAT_SlashDebrisFragmentsAwake, STATGROUP_Slash);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Physics Scene Tick, Wall Time (ms)"), STAT_SlashPhysicsSceneTick, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarDebrisBudget(
+	TEXT("slash.Breakable.DebrisBudget"),
+	true,
+	TEXT("Sleep, fade and cap the fragments shattered breakables leave behind. Applies to breakables that shatter after the change"));
+
+static TAutoConsoleVariable<float> CVarDebrisSettleSeconds(
+	TEXT("slash.Breakable.DebrisSettleSeconds"),
+	3.f,
+	TEXT("Seconds after shattering before slow debris fragments start being put to sleep"));
+
+static TAutoConsoleVariable<float> CVarDebrisSleepLinearSpeed(
+	TEXT("slash.Breakable.DebrisSleepLinearSpeed"),
+	5.f,
+	TEXT("Fragments slower than this, in cm/s, are put to sleep once debris has settled"));
+
+static TAutoConsoleVariable<float> CVarDebrisSleepAngularSpeed(
+	TEXT("slash.Breakable.DebrisSleepAngularSpeed"),
+	0.1f,
+	TEXT("Fragments spinning slower than this, in rad/s, are put to sleep once debris has settled"));
+
+static TAutoConsoleVariable<float> CVarDebrisLifetime(
+	TEXT("slash.Breakable.DebrisLifetime"),
+	15.f,
+	TEXT("Seconds after shattering before debris starts fading out"));
+
+static TAutoConsoleVariable<float> CVarDebrisFadeSeconds(
+	TEXT("slash.Breakable.DebrisFadeSeconds"),
+	1.5f,
+	TEXT("How long debris takes to fade out before it's removed"));
+
+static TAutoConsoleVariable<int32> CVarMaxDebrisFragments(
+	TEXT("slash.Breakable.MaxDebrisFragments"),
+	600,
+	TEXT("Most fragments left in the physics scene, the oldest debris is removed first past this"));
+
+// Scalar parameter a debris material can read to fade itself out, 0 is fully visible
+static const FName DebrisFadeParameter(TEXT("DebrisFade"));
+
+void UBreakableDebrisSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	SLASH_SCOPE_HOT_PATH(BreakableDebris);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double SettleSeconds = CVarDebrisSettleSeconds.GetValueOnGameThread();
+	const double Lifetime = CVarDebrisLifetime.GetValueOnGameThread();
+	const double FadeSeconds = FMath::Max(CVarDebrisFadeSeconds.GetValueOnGameThread(), 0.f);
+
+	int32 LiveFragments = 0;
+	int32 AwakeFragments = 0;
+	for (int32 DebrisIndex = 0; DebrisIndex < Debris.Num();) {
+		ABreakableActor* Breakable = Debris[DebrisIndex];
+		const double Age = Now - BreakTimes[DebrisIndex];
+		if (!IsValid(Breakable) || Age >= Lifetime + FadeSeconds) {
+			RemoveDebris(DebrisIndex);
+			continue;
+		}
+
+		// Checked every frame until the last fragment stops, whatever is still rolling stays awake
+		if (AwakeCounts[DebrisIndex] > 0 && Age >= SettleSeconds) {
+			AwakeCounts[DebrisIndex] = SleepSlowFragments(Breakable);
+		}
+		if (Age >= Lifetime && FadeSeconds > 0.0) {
+			Breakable->GetGeometryCollection()->SetScalarParameterValueOnMaterials(DebrisFadeParameter, (float)((Age - Lifetime) / FadeSeconds));
+		}
+
+		LiveFragments += FragmentCounts[DebrisIndex];
+		AwakeFragments += AwakeCounts[DebrisIndex];
+		++DebrisIndex;
+	}
+
+	// Over budget, the oldest go first. The newest is always kept so a fresh break still shows
+	const int32 MaxFragments = CVarMaxDebrisFragments.GetValueOnGameThread();
+	while (LiveFragments > MaxFragments && Debris.Num() > 1) {
+		LiveFragments -= FragmentCounts[0];
+		AwakeFragments -= AwakeCounts[0];
+		RemoveDebris(0);
+	}
+
+	SLASH_SET_COUNT(DebrisFragmentsLive, LiveFragments);
+	SLASH_SET_COUNT(DebrisFragmentsAwake, AwakeFragments);
+}
+
+TStatId UBreakableDebrisSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBreakableDebrisSubsystem, STATGROUP_Tickables);
+}
+
+void UBreakableDebrisSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+#if SLASH_INSTRUMENTATION
+	if (FPhysScene_Chaos* PhysScene = InWorld.GetPhysicsScene()) {
+		PhysicsPreTickHandle = PhysScene->OnPhysScenePreTick.AddUObject(this, &UBreakableDebrisSubsystem::OnPhysicsPreTick);
+		PhysicsPostTickHandle = PhysScene->OnPhysScenePostTick.AddUObject(this, &UBreakableDebrisSubsystem::OnPhysicsPostTick);
+	}
+#endif
+}
+
+void UBreakableDebrisSubsystem::Deinitialize() {
+	FPhysScene_Chaos* PhysScene = GetWorld() ? GetWorld()->GetPhysicsScene() : nullptr;
+	if (PhysScene) {
+		PhysScene->OnPhysScenePreTick.Remove(PhysicsPreTickHandle);
+		PhysScene->OnPhysScenePostTick.Remove(PhysicsPostTickHandle);
+	}
+	Super::Deinitialize();
+}
+
+bool UBreakableDebrisSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UBreakableDebrisSubsystem::IsBudgetEnabled() const {
+	return CVarDebrisBudget.GetValueOnGameThread();
+}
+
+void UBreakableDebrisSubsystem::RegisterDebris(ABreakableActor* Breakable) {
+	if (Breakable == nullptr || Debris.Contains(Breakable)) { return; }
+
+	Debris.Add(Breakable);
+	BreakTimes.Add(GetWorld()->GetTimeSeconds());
+	FragmentCounts.Add(CountFragments(Breakable));
+	AwakeCounts.Add(FragmentCounts.Last());
+}
+
+int32 UBreakableDebrisSubsystem::SleepSlowFragments(ABreakableActor* Breakable) {
+	TArray<Chaos::FPhysicsObjectHandle> Fragments = Breakable->GetGeometryCollection()->GetAllPhysicsObjects();
+	if (Fragments.Num() == 0) { return 0; }
+
+	const double MaxLinearSpeedSquared = FMath::Square(CVarDebrisSleepLinearSpeed.GetValueOnGameThread());
+	const double MaxAngularSpeedSquared = FMath::Square(CVarDebrisSleepAngularSpeed.GetValueOnGameThread());
+
+	// Chaos sleeps pieces below its own thresholds, this catches the ones left jittering just above them. Anything hitting them wakes them again
+	FLockedWritePhysicsObjectExternalInterface Interface = FPhysicsObjectExternalInterface::LockWrite(Fragments);
+	TArray<Chaos::FPhysicsObjectHandle> SlowFragments;
+	int32 NumAwake = 0;
+	for (Chaos::FPhysicsObjectHandle& Fragment : Fragments) {
+		const TArrayView<Chaos::FPhysicsObjectHandle> FragmentView(&Fragment, 1);
+		if (Interface->AreAllDisabled(FragmentView) || Interface->AreAllSleeping(FragmentView)) { continue; }
+
+		if (Interface->GetV(Fragment).SizeSquared() <= MaxLinearSpeedSquared && Interface->GetW(Fragment).SizeSquared() <= MaxAngularSpeedSquared) {
+			SlowFragments.Add(Fragment);
+		} else {
+			++NumAwake;
+		}
+	}
+	if (SlowFragments.Num() > 0) {
+		Interface->PutToSleep(SlowFragments);
+	}
+	return NumAwake;
+}
+
+void UBreakableDebrisSubsystem::RemoveDebris(int32 DebrisIndex) {
+	ABreakableActor* Breakable = Debris[DebrisIndex];
+	// Shifted rather than swapped, eviction relies on the oldest being first
+	Debris.RemoveAt(DebrisIndex);
+	BreakTimes.RemoveAt(DebrisIndex);
+	FragmentCounts.RemoveAt(DebrisIndex);
+	AwakeCounts.RemoveAt(DebrisIndex);
+
+	// Nothing's left of a shattered breakable but its fragments, its loot already dropped
+	if (IsValid(Breakable)) {
+		Breakable->Destroy();
+	}
+}
+
+int32 UBreakableDebrisSubsystem::CountFragments(const ABreakableActor* Breakable) {
+	const UGeometryCollectionComponent* GeometryCollection = Breakable->GetGeometryCollection();
+	const UGeometryCollection* RestCollection = GeometryCollection ? GeometryCollection->GetRestCollection() : nullptr;
+	return RestCollection ? RestCollection->NumElements(FGeometryCollection::GeometryGroup) : 0;
+}
+
+void UBreakableDebrisSubsystem::OnPhysicsPreTick(FPhysScene_Chaos* PhysScene, float DeltaSeconds) {
+	PhysicsStartCycles = FPlatformTime::Cycles64();
+}
+
+void UBreakableDebrisSubsystem::OnPhysicsPostTick(FChaosScene* PhysScene) {
+	if (PhysicsStartCycles == 0) { return; }
+	// Game thread wall time from the scene's pre tick to its post tick. It includes whatever else the game
+	// thread did while the solver ran, so it's an upper bound on the solver, not its cost. Chaos' own stats have that
+	SLASH_SET_MS(PhysicsSceneTick, FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - PhysicsStartCycles));
+	PhysicsStartCycles = 0;
+}
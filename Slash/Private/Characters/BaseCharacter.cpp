@@ -5,15 +5,21 @@
 #include "Components/BoxComponent.h"
 #include "Items/Weapons/Weapon.h"
 #include "Components/AttributeComponent.h"
+#include "Components/FactionComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/CapsuleComponent.h"
+#include "Combat/CombatFXSubsystem.h"
+#include "Combat/StatusEffectSubsystem.h"
+#include "Slash/SlashStats.h"
 
-ABaseCharacter::ABaseCharacter()
+ABaseCharacter::ABaseCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
 	PrimaryActorTick.bCanEverTick = true;
 
 	// Setting up attributes
 	Attributes = CreateDefaultSubobject<UAttributeComponent>(TEXT("Attributes"));
+	Faction = CreateDefaultSubobject<UFactionComponent>(TEXT("Faction"));
 	// Never want characters to block the camera
 	GetCapsuleComponent()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
 
@@ -35,7 +41,7 @@ void ABaseCharacter::GetHit_Implementation(const FVector& ImpactPoint, AActor* H
 }
 
 void ABaseCharacter::Attack() {
-	if (CombatTarget && CombatTarget->ActorHasTag(FName("Dead"))) {
+	if (UFactionComponent::ActorHasFlags(CombatTarget, EFactionFlags::EFF_Dead)) {
 		CombatTarget = nullptr;
 	}
 }
@@ -53,7 +59,11 @@ void ABaseCharacter::DisableMeshCollision() {
 }
 
 void ABaseCharacter::Die_Implementation() {
-	Tags.Add(FName("Dead"));
+	SLASH_COMBAT_EVENT(Death, this);
+	Faction->AddFlags(EFactionFlags::EFF_Dead);
+	if (UStatusEffectSubsystem* StatusEffects = GetWorld()->GetSubsystem<UStatusEffectSubsystem>()) {
+		StatusEffects->ClearEffects(Attributes);
+	}
 	PlayDeathMontage();
 	SetWeaponCollision(ECollisionEnabled::NoCollision);
 }
@@ -92,7 +102,10 @@ void ABaseCharacter::DirectionalHitReact(const FVector& ImpactPoint) {
 }
 
 void ABaseCharacter::PlayHitSound(const FVector& ImpactPoint) {
-	if (HitSound) {
+	if (HitSound == nullptr) { return; }
+	if (UCombatFXSubsystem* CombatFX = GetWorld()->GetSubsystem<UCombatFXSubsystem>()) {
+		CombatFX->QueueSound(HitSound, ImpactPoint);
+	} else {
 		UGameplayStatics::PlaySoundAtLocation(
 			this,
 			HitSound,
@@ -102,7 +115,10 @@ void ABaseCharacter::PlayHitSound(const FVector& ImpactPoint) {
 }
 
 void ABaseCharacter::SpawnHitParticles(const FVector& ImpactPoint) {
-	if (HitParticles) {
+	if (HitParticles == nullptr) { return; }
+	if (UCombatFXSubsystem* CombatFX = GetWorld()->GetSubsystem<UCombatFXSubsystem>()) {
+		CombatFX->QueueParticles(HitParticles, ImpactPoint);
+	} else {
 		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), HitParticles, ImpactPoint);
 	}
 }
@@ -175,6 +191,7 @@ void ABaseCharacter::DisableCapsule() {
 }
 
 void ABaseCharacter::AttackEnd() {
+	SLASH_COMBAT_EVENT(AttackEnd, this);
 }
 
 void ABaseCharacter::DodgeEnd() {
@@ -189,7 +206,7 @@ void ABaseCharacter::Tick(float DeltaTime)
 void ABaseCharacter::SetWeaponCollision(ECollisionEnabled::Type CollisionEnabled) {
 	if (EquippedWeapon && EquippedWeapon->GetWeaponBox()) {
 		EquippedWeapon->GetWeaponBox()->SetCollisionEnabled(CollisionEnabled);
-		EquippedWeapon->IgnoreActors.Empty();
+		EquippedWeapon->SetSwingActive(CollisionEnabled != ECollisionEnabled::NoCollision);
 	}
 }
 
@@ -15,6 +15,9 @@
 #include "Camera/CameraComponent.h"
 #include "Components/InputComponent.h"
 #include "Components/AttributeComponent.h"
+#include "Components/FactionComponent.h"
+#include "Combat/CombatRules.h"
+#include "Slash/SlashStats.h"
 #include "Components/StaticMeshComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
@@ -22,6 +25,9 @@
 /* Misc */
 #include "Animation/AnimMontage.h"
 
+/* Combat */
+#include "Combat/CombatGridSubsystem.h"
+
 /* Overlay */
 #include "HUD/SlashHUD.h"
 #include "HUD/SlashOverlay.h"
@@ -31,7 +37,8 @@
 // Sets default values
 ASlashCharacter::ASlashCharacter()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// Attributes regenerate on read and the HUD follows their change events, nothing left to tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Overwriting defaults
 	bUseControllerRotationPitch = false;
@@ -72,13 +79,6 @@ ASlashCharacter::ASlashCharacter()
 	
 }
 
-void ASlashCharacter::Tick(float DeltaTime) {
-	if (Attributes && SlashOverlay) {
-		Attributes->RegenStamina(DeltaTime);
-		SlashOverlay->SetStaminaBarPercent(Attributes->GetStaminaPercent());
-	}
-}
-
 // Called when the game starts or when spawned
 void ASlashCharacter::BeginPlay()
 {
@@ -89,8 +89,19 @@ void ASlashCharacter::BeginPlay()
 			Subsystem->AddMappingContext(SlashContext, 0);
 		}
 	}
-	Tags.Add(FName("EngageableTarget"));
+	Faction->AddFlags(EFactionFlags::EFF_Engageable);
 	InitializeSlashOverlay();
+
+	if (UCombatGridSubsystem* CombatGrid = GetWorld()->GetSubsystem<UCombatGridSubsystem>()) {
+		CombatGrid->RegisterTarget(this);
+	}
+}
+
+void ASlashCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UCombatGridSubsystem* CombatGrid = GetWorld()->GetSubsystem<UCombatGridSubsystem>()) {
+		CombatGrid->UnregisterTarget(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 void ASlashCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -110,7 +121,6 @@ void ASlashCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComp
 
 float ASlashCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) {
 	HandleDamage(DamageAmount);
-	SetHUDHealth();
 	return DamageAmount;
 }
 
@@ -128,16 +138,14 @@ void ASlashCharacter::SetOverlappingItem(AItem* Item) {
 }
 
 void ASlashCharacter::AddSouls(ASoul* Soul) {
-	if (Attributes && SlashOverlay) {
+	if (Attributes) {
 		Attributes->AddSouls(Soul->GetSouls());
-		SlashOverlay->SetSouls(Attributes->GetSouls());
 	}
 }
 
 void ASlashCharacter::AddGold(ATreasure* Treasure) {
 	if (Attributes) {
 		Attributes->AddGold(Treasure->GetGold());
-		SlashOverlay->SetGold(Attributes->GetGold());
 	}
 }
 
@@ -191,6 +199,7 @@ void ASlashCharacter::Jump() {
 void ASlashCharacter::Attack() {
 	Super::Attack();
 	if (CanAttack()) {
+		SLASH_COMBAT_EVENT(AttackStart, this);
 		PlayAttackMontage();
 		ActionState = EActionState::EAS_Attacking;
 	}
@@ -200,9 +209,8 @@ void ASlashCharacter::Dodge() {
 	if (IsOccupied() || !HasEnoughStamina()) { return; }
 	PlayDodgeMontage();
 	ActionState = EActionState::EAS_Dodging;
-	if (Attributes && SlashOverlay) {
+	if (Attributes) {
 		Attributes->UseStamina(Attributes->GetDodgeCost());
-		SlashOverlay->SetStaminaBarPercent(Attributes->GetStaminaPercent());
 	}
 }
 
@@ -247,10 +255,15 @@ void ASlashCharacter::Die_Implementation() {
 	DisableCapsule();
 	GetCharacterMovement()->bOrientRotationToMovement = false;
 	SetWeaponCollision(ECollisionEnabled::NoCollision);
+
+	// Nothing left for enemies to engage
+	if (UCombatGridSubsystem* CombatGrid = GetWorld()->GetSubsystem<UCombatGridSubsystem>()) {
+		CombatGrid->UnregisterTarget(this);
+	}
 }
 
 bool ASlashCharacter::HasEnoughStamina() {
-	return Attributes && Attributes->GetStamina() > Attributes->GetDodgeCost();
+	return Attributes && FCombatRules::CanAffordStamina(Attributes->GetStamina(), Attributes->GetDodgeCost());
 }
 
 bool ASlashCharacter::IsOccupied() {
@@ -317,17 +330,8 @@ void ASlashCharacter::InitializeSlashOverlay() {
 		if (SlashHUD) {
 			SlashOverlay = SlashHUD->GetSlashOverlay();
 			if (SlashOverlay && Attributes) {
-				SlashOverlay->SetHealthBarPercent(Attributes->GetHealthPercent());
-				SlashOverlay->SetStaminaBarPercent(1.f);
-				SlashOverlay->SetGold(0);
-				SlashOverlay->SetSouls(0);
+				SlashOverlay->BindAttributes(Attributes);
 			}
 		}
 	}
 }
-
-void ASlashCharacter::SetHUDHealth() {
-	if (SlashOverlay && Attributes) {
-		SlashOverlay->SetHealthBarPercent(Attributes->GetHealthPercent());
-	}
-}
\ No newline at end of file
@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/CombatBenchmark.h"
+#include "Combat/CombatRules.h"
+#include "Characters/CharacterTypes.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "Slash/SlashStats.h"
+
+namespace CombatBenchmark {
+	// Roughly the default player and enemy numbers
+	static constexpr float PlayerMaxHealth = 100.f;
+	static constexpr float PlayerMaxStamina = 100.f;
+	static constexpr float PlayerDamage = 20.f;
+	static constexpr float DodgeCost = 14.f;
+	static constexpr float StaminaRegenRate = 8.f;
+	static constexpr float EnemyMaxHealth = 100.f;
+	static constexpr float EnemyDamage = 20.f;
+	static constexpr float EnemyAttackMin = 0.5f;
+	static constexpr float EnemyAttackMax = 1.f;
+	static constexpr float ExchangeTime = 0.5f;
+	static constexpr double PlayerStep = 150.0;
+	static constexpr double PlayerMaxDistance = 1200.0;
+	static constexpr float PlayerSwingChance = 0.5f;
+	// The player's sword reaches a bit past the enemy's attack radius, so hits land from the combat band too
+	static constexpr double PlayerReach = 250.0;
+	// Pawn sensing sees further than the player wanders, but only when the enemy happens to face them
+	static constexpr float SpotChance = 0.5f;
+}
+
+FCombatBenchmark::FResult FCombatBenchmark::Run(int64 NumExchanges, int32 Seed) {
+	using namespace CombatBenchmark;
+
+	FRandomStream Random(Seed);
+	FResult Result;
+
+	float PlayerHealth = PlayerMaxHealth;
+	float PlayerStamina = PlayerMaxStamina;
+	float EnemyHealth = EnemyMaxHealth;
+
+	FEnemyAIInput Input;
+	Input.bHasCombatTarget = true;
+	Input.CombatRadius = 1000.0;
+	Input.AttackRadius = 175.0;
+	Input.PatrolRadius = 200.0;
+	Input.EnemyState = EEnemyState::EES_Chasing;
+
+	// AEnemy's attack timer, the enemy swings when it runs out. Zero when it isn't set
+	float AttackTimeLeft = 0.f;
+	auto StartAttackTimer = [&Input, &AttackTimeLeft, &Random]() {
+		Input.EnemyState = EEnemyState::EES_Attacking;
+		AttackTimeLeft = Random.FRandRange(EnemyAttackMin, EnemyAttackMax);
+	};
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int64 Exchange = 0; Exchange < NumExchanges; ++Exchange) {
+		// Player wanders in and out of range of the enemy, a step at a time so it stays close for a few exchanges
+		const double PlayerX = FMath::Clamp(Input.CombatTargetLocation.X + Random.FRandRange(-PlayerStep, PlayerStep), 0.0, PlayerMaxDistance);
+		Input.CombatTargetLocation = FVector(PlayerX, 0.0, 0.0);
+
+		// Patrolling enemy spots the player again, AEnemy::PawnSeen
+		if (Input.EnemyState == EEnemyState::EES_Patrolling && Random.FRand() < SpotChance) {
+			Input.bHasCombatTarget = true;
+			Input.EnemyState = EEnemyState::EES_Chasing;
+		}
+		const EEnemyAIDecision Decision = FCombatRules::DecideAction(Input, FCombatRules::ClassifyCombatRange(Input));
+
+		switch (Decision) {
+		case EEnemyAIDecision::EAD_StartAttack:
+			StartAttackTimer();
+			break;
+		case EEnemyAIDecision::EAD_Chase:
+			AttackTimeLeft = 0.f;
+			Input.EnemyState = EEnemyState::EES_Chasing;
+			break;
+		case EEnemyAIDecision::EAD_LoseInterest:
+			// LoseInterest then StartPatrolling
+			AttackTimeLeft = 0.f;
+			Input.bHasCombatTarget = false;
+			Input.EnemyState = EEnemyState::EES_Patrolling;
+			++Result.LostInterest;
+			break;
+		default:
+			break;
+		}
+
+		// The swing lands and its montage ends within the exchange, then AttackEnd hands the enemy back to the decision
+		if (AttackTimeLeft > 0.f) {
+			AttackTimeLeft -= ExchangeTime;
+			if (AttackTimeLeft <= 0.f) {
+				AttackTimeLeft = 0.f;
+				++Result.EnemyAttacks;
+				if (FCombatRules::CanAffordStamina(PlayerStamina, DodgeCost) && Random.FRand() < 0.5f) {
+					PlayerStamina = FCombatRules::SpendStamina(PlayerStamina, PlayerMaxStamina, DodgeCost);
+					++Result.Dodges;
+				} else {
+					PlayerHealth = FCombatRules::ApplyDamage(PlayerHealth, PlayerMaxHealth, EnemyDamage);
+				}
+				Input.EnemyState = EEnemyState::EES_NoState;
+			}
+		}
+
+		// Player swings at the enemy some of the time it's in reach. Like AEnemy::TakeDamage, the hit makes the player the
+		// combat target and the enemy attacks back from inside its attack radius, otherwise it chases
+		if (FCombatRules::IsInRange(Input.Location, Input.CombatTargetLocation, PlayerReach) && Random.FRand() < PlayerSwingChance) {
+			EnemyHealth = FCombatRules::ApplyDamage(EnemyHealth, EnemyMaxHealth, PlayerDamage);
+			Input.bHasCombatTarget = true;
+			const bool bInsideAttackRadius = FCombatRules::ClassifyCombatRange(Input) == ECombatRangeBand::ECRB_InsideAttack;
+			if (FCombatRules::EnemyStateWhenDamaged(bInsideAttackRadius) == EEnemyState::EES_Attacking) {
+				StartAttackTimer();
+			} else {
+				AttackTimeLeft = 0.f;
+				Input.EnemyState = EEnemyState::EES_Chasing;
+			}
+		}
+		PlayerStamina = FCombatRules::RegenStamina(PlayerStamina, PlayerMaxStamina, StaminaRegenRate, ExchangeTime);
+
+		if (!FCombatRules::IsAlive(EnemyHealth)) {
+			++Result.EnemyKills;
+			EnemyHealth = EnemyMaxHealth;
+			AttackTimeLeft = 0.f;
+			Input.bHasCombatTarget = true;
+			Input.EnemyState = EEnemyState::EES_Chasing;
+		}
+		if (!FCombatRules::IsAlive(PlayerHealth)) {
+			++Result.PlayerDeaths;
+			PlayerHealth = PlayerMaxHealth;
+			PlayerStamina = PlayerMaxStamina;
+		}
+	}
+	Result.Seconds = FPlatformTime::Seconds() - StartTime;
+	Result.Exchanges = NumExchanges;
+	return Result;
+}
+
+/*
+* Console command
+*/
+#if SLASH_INSTRUMENTATION
+namespace CombatBenchmark {
+	static void RunFromConsole(const TArray<FString>& Args) {
+		const int64 NumExchanges = Args.Num() > 0 ? FMath::Max<int64>(1, FCString::Atoi64(*Args[0])) : 10000000;
+		const int32 Seed = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1;
+
+		const FCombatBenchmark::FResult Result = FCombatBenchmark::Run(NumExchanges, Seed);
+		const double ExchangesPerSecond = Result.Seconds > 0.0 ? Result.Exchanges / Result.Seconds : 0.0;
+		UE_LOG(LogTemp, Display, TEXT("Combat benchmark: %lld exchanges in %.3fs (%.2fM/s), seed %d"),
+			Result.Exchanges, Result.Seconds, ExchangesPerSecond / 1000000.0, Seed);
+		UE_LOG(LogTemp, Display, TEXT("Combat benchmark: %lld enemy kills, %lld player deaths, %lld enemy attacks, %lld dodges, lost interest %lld times"),
+			Result.EnemyKills, Result.PlayerDeaths, Result.EnemyAttacks, Result.Dodges, Result.LostInterest);
+	}
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("slash.Combat.Benchmark"),
+		TEXT("Runs attacker/defender exchanges through the combat rules with no world and logs the outcome and exchanges per second. Args: [Exchanges] [Seed]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunFromConsole));
+}
+#endif
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/CombatDamageSubsystem.h"
+#include "Slash/SlashStats.h"
+#include "Items/Weapons/Weapon.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Resolve"), STAT_SlashDamageResolve, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Events"), STAT_SlashDamageEvents, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Targets Resolved"), STAT_SlashDamageTargets, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarCombatDeferDamage(
+	TEXT("slash.Combat.DeferDamage"),
+	true,
+	TEXT("Queue weapon hits and resolve them once per frame. Turn off to apply damage inside the trace that found the hit"));
+
+void UCombatDamageSubsystem::Tick(float DeltaTime) {
+	SLASH_BENCHMARK_SCOPE(ESBC_Combat);
+	Super::Tick(DeltaTime);
+
+	SLASH_SET_COUNT(DamageEvents, PendingEvents.Num());
+	if (PendingEvents.Num() > 0) {
+		ResolveDamage();
+	}
+}
+
+TStatId UCombatDamageSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatDamageSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatDamageSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UCombatDamageSubsystem::IsDeferringDamage() const {
+	return CVarCombatDeferDamage.GetValueOnGameThread();
+}
+
+void UCombatDamageSubsystem::QueueDamage(AActor* Target, AWeapon* Weapon, float Damage, const FVector& ImpactPoint) {
+	if (Target == nullptr || Weapon == nullptr) { return; }
+
+	FCombatDamageEvent& Event = PendingEvents.AddDefaulted_GetRef();
+	Event.Target = Target;
+	Event.Weapon = Weapon;
+	Event.ImpactPoint = ImpactPoint;
+	Event.Damage = Damage;
+	Event.TargetId = Target->GetUniqueID();
+	Event.Sequence = NextSequence++;
+	++NumQueued;
+}
+
+void UCombatDamageSubsystem::ResolveDamage() {
+	SLASH_SCOPE_HOT_PATH(DamageResolve);
+	Swap(PendingEvents, ResolvingEvents);
+
+	// Same hits always resolve in the same order, whatever order collision found them in
+	ResolvingEvents.Sort([](const FCombatDamageEvent& A, const FCombatDamageEvent& B) {
+		if (A.TargetId != B.TargetId) { return A.TargetId < B.TargetId; }
+		return A.Sequence < B.Sequence;
+	});
+
+	int32 NumTargets = 0;
+	int32 First = 0;
+	while (First < ResolvingEvents.Num()) {
+		const uint32 TargetId = ResolvingEvents[First].TargetId;
+		float TotalDamage = 0.f;
+		const FCombatDamageEvent* FirstHit = nullptr;
+		int32 Last = First;
+		for (; Last < ResolvingEvents.Num() && ResolvingEvents[Last].TargetId == TargetId; ++Last) {
+			const FCombatDamageEvent& Event = ResolvingEvents[Last];
+			// Weapon may have been destroyed since the hit was queued, its damage goes with it
+			if (!Event.Weapon.IsValid()) { continue; }
+			TotalDamage += Event.Damage;
+			if (FirstHit == nullptr) { FirstHit = &Event; }
+		}
+
+		AActor* Target = ResolvingEvents[First].Target.Get();
+		if (FirstHit && IsValid(Target)) {
+			FirstHit->Weapon->ResolveHit(Target, TotalDamage, FirstHit->ImpactPoint);
+			++NumTargets;
+		}
+		NumResolved += Last - First;
+		First = Last;
+	}
+	ResolvingEvents.Reset();
+
+	SLASH_COUNT(DamageTargets, NumTargets);
+}
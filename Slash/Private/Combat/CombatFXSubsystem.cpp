@@ -0,0 +1,218 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/CombatFXSubsystem.h"
+#include "Slash/SlashStats.h"
+#include "Kismet/GameplayStatics.h"
+#include "Components/AudioComponent.h"
+#include "NiagaraFunctionLibrary.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "NiagaraComponent.h"
+#include "Sound/SoundBase.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Requested"), STAT_SlashFXRequested, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Spawned"), STAT_SlashFXSpawned, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FX Dropped"), STAT_SlashFXDropped, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Audio Components"), STAT_SlashFXAudioPool, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Particle Effects"), STAT_SlashFXLiveParticles, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Niagara Effects"), STAT_SlashFXLiveNiagara, STATGROUP_Slash);
+
+static TAutoConsoleVariable<float> CVarCombatFXMergeRadius(
+	TEXT("slash.FX.MergeRadius"),
+	100.f,
+	TEXT("Requests for the same effect closer together than this in one frame are merged"));
+
+static TAutoConsoleVariable<int32> CVarCombatFXMaxPerFrame(
+	TEXT("slash.FX.MaxPerFrame"),
+	8,
+	TEXT("Most effects of each type (sound, particles, Niagara) spawned in one frame"));
+
+static TAutoConsoleVariable<int32> CVarCombatFXMaxAudioComponents(
+	TEXT("slash.FX.MaxAudioComponents"),
+	16,
+	TEXT("Most combat sounds playing at once, requests past this are dropped"));
+
+static TAutoConsoleVariable<int32> CVarCombatFXMaxLiveParticles(
+	TEXT("slash.FX.MaxLiveParticles"),
+	24,
+	TEXT("Most combat particle effects playing at once, requests past this are dropped"));
+
+static TAutoConsoleVariable<int32> CVarCombatFXMaxLiveNiagara(
+	TEXT("slash.FX.MaxLiveNiagara"),
+	24,
+	TEXT("Most combat Niagara effects playing at once, requests past this are dropped"));
+
+void UCombatFXSubsystem::Tick(float DeltaTime) {
+	SLASH_BENCHMARK_SCOPE(ESBC_Combat);
+	Super::Tick(DeltaTime);
+
+	ReleaseFinishedEffects();
+	SLASH_SET_COUNT(FXAudioPool, AudioPool.Num());
+	SLASH_SET_COUNT(FXLiveParticles, NumLive[(uint8)ECombatFXType::ECFX_Particles]);
+	SLASH_SET_COUNT(FXLiveNiagara, NumLive[(uint8)ECombatFXType::ECFX_Niagara]);
+	if (PendingRequests.Num() == 0) { return; }
+
+	const double MergeRadiusSquared = FMath::Square((double)CVarCombatFXMergeRadius.GetValueOnGameThread());
+	const int32 MaxPerFrame = CVarCombatFXMaxPerFrame.GetValueOnGameThread();
+	int32 NumSpawnedThisFrame[(uint8)ECombatFXType::ECFX_MAX] = {};
+
+	AcceptedRequests.Reset();
+	for (const FCombatFXRequest& Request : PendingRequests) {
+		const bool bMerged = AcceptedRequests.ContainsByPredicate([&Request, MergeRadiusSquared](const FCombatFXRequest& Accepted) {
+			return Accepted.Asset == Request.Asset && FVector::DistSquared(Accepted.Location, Request.Location) <= MergeRadiusSquared;
+		});
+		if (bMerged) { continue; }
+
+		int32& NumOfType = NumSpawnedThisFrame[(uint8)Request.Type];
+		AcceptedRequests.Add(Request);
+		if (NumOfType < MaxPerFrame && SpawnEffect(Request)) {
+			++NumOfType;
+			++NumSpawned[(uint8)Request.Type];
+			SLASH_COUNT(FXSpawned, 1);
+		} else {
+			++NumDropped[(uint8)Request.Type];
+			SLASH_COUNT(FXDropped, 1);
+		}
+	}
+	PendingRequests.Reset();
+}
+
+TStatId UCombatFXSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatFXSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatFXSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatFXSubsystem::QueueSound(USoundBase* Sound, const FVector& Location) {
+	Queue(Sound, Location, ECombatFXType::ECFX_Sound);
+}
+
+void UCombatFXSubsystem::QueueParticles(UParticleSystem* Particles, const FVector& Location) {
+	Queue(Particles, Location, ECombatFXType::ECFX_Particles);
+}
+
+void UCombatFXSubsystem::QueueNiagara(UNiagaraSystem* System, const FVector& Location) {
+	Queue(System, Location, ECombatFXType::ECFX_Niagara);
+}
+
+void UCombatFXSubsystem::Queue(UObject* Asset, const FVector& Location, ECombatFXType Type) {
+	if (Asset == nullptr) { return; }
+	FCombatFXRequest& Request = PendingRequests.AddDefaulted_GetRef();
+	Request.Asset = Asset;
+	Request.Location = Location;
+	Request.Type = Type;
+	++NumRequested[(uint8)Type];
+	SLASH_COUNT(FXRequested, 1);
+}
+
+bool UCombatFXSubsystem::SpawnEffect(const FCombatFXRequest& Request) {
+	UWorld* World = GetWorld();
+	switch (Request.Type) {
+	case ECombatFXType::ECFX_Sound: {
+		USoundBase* Sound = static_cast<USoundBase*>(Request.Asset);
+		if (UAudioComponent* AudioComponent = FindFreeAudioComponent()) {
+			AudioComponent->SetSound(Sound);
+			AudioComponent->SetWorldLocation(Request.Location);
+			AudioComponent->Play();
+			return true;
+		}
+		// Every pooled component is busy, that's our concurrency limit
+		if (AudioPool.Num() >= GetMaxLive(Request.Type)) { return false; }
+
+		// Not auto destroyed, so it goes back in the pool once it finishes playing
+		UAudioComponent* AudioComponent = UGameplayStatics::SpawnSoundAtLocation(
+			World,
+			Sound,
+			Request.Location,
+			FRotator::ZeroRotator,
+			1.f,
+			1.f,
+			0.f,
+			nullptr,
+			nullptr,
+			false
+		);
+		if (AudioComponent) {
+			AudioPool.Add(AudioComponent);
+		}
+		return AudioComponent != nullptr;
+	}
+	case ECombatFXType::ECFX_Particles: {
+		if (NumLive[(uint8)Request.Type] >= GetMaxLive(Request.Type)) { return false; }
+		// Released by hand once it finishes, so we know how many are still playing
+		UParticleSystemComponent* Particles = UGameplayStatics::SpawnEmitterAtLocation(
+			World,
+			static_cast<UParticleSystem*>(Request.Asset),
+			Request.Location,
+			FRotator::ZeroRotator,
+			FVector(1.f),
+			false,
+			EPSCPoolMethod::ManualRelease
+		);
+		TrackLiveEffect(Particles, Request.Type);
+		return Particles != nullptr;
+	}
+	case ECombatFXType::ECFX_Niagara: {
+		if (NumLive[(uint8)Request.Type] >= GetMaxLive(Request.Type)) { return false; }
+		UNiagaraComponent* Niagara = UNiagaraFunctionLibrary::SpawnSystemAtLocation(
+			World,
+			static_cast<UNiagaraSystem*>(Request.Asset),
+			Request.Location,
+			FRotator::ZeroRotator,
+			FVector(1.f),
+			false,
+			true,
+			ENCPoolMethod::ManualRelease
+		);
+		TrackLiveEffect(Niagara, Request.Type);
+		return Niagara != nullptr;
+	}
+	default:
+		return false;
+	}
+}
+
+UAudioComponent* UCombatFXSubsystem::FindFreeAudioComponent() const {
+	for (UAudioComponent* AudioComponent : AudioPool) {
+		if (AudioComponent && !AudioComponent->IsPlaying()) {
+			return AudioComponent;
+		}
+	}
+	return nullptr;
+}
+
+void UCombatFXSubsystem::TrackLiveEffect(UFXSystemComponent* Component, ECombatFXType Type) {
+	if (Component == nullptr) { return; }
+	LiveEffects.Add(Component);
+	LiveEffectTypes.Add(Type);
+	++NumLive[(uint8)Type];
+}
+
+void UCombatFXSubsystem::ReleaseFinishedEffects() {
+	// Backwards so each swap only brings in an effect that's already been checked
+	for (int32 Index = LiveEffects.Num() - 1; Index >= 0; --Index) {
+		UFXSystemComponent* Component = LiveEffects[Index];
+		if (IsValid(Component) && Component->IsActive()) { continue; }
+
+		if (IsValid(Component)) {
+			Component->ReleaseToPool();
+		}
+		--NumLive[(uint8)LiveEffectTypes[Index]];
+		LiveEffects.RemoveAtSwap(Index);
+		LiveEffectTypes.RemoveAtSwap(Index);
+	}
+}
+
+int32 UCombatFXSubsystem::GetMaxLive(ECombatFXType Type) const {
+	switch (Type) {
+	case ECombatFXType::ECFX_Particles:
+		return CVarCombatFXMaxLiveParticles.GetValueOnGameThread();
+	case ECombatFXType::ECFX_Niagara:
+		return CVarCombatFXMaxLiveNiagara.GetValueOnGameThread();
+	default:
+		return CVarCombatFXMaxAudioComponents.GetValueOnGameThread();
+	}
+}
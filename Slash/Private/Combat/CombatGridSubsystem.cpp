@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/CombatGridSubsystem.h"
+#include "GameFramework/Pawn.h"
+#include "Slash/SlashStats.h"
+
+void UCombatGridSubsystem::Tick(float DeltaTime) {
+	SLASH_BENCHMARK_SCOPE(ESBC_AI);
+	Super::Tick(DeltaTime);
+
+	// Walk backwards so removing stale entries doesn't skip anything
+	for (int32 Index = Entries.Num() - 1; Index >= 0; --Index) {
+		APawn* Pawn = Entries[Index].Pawn.Get();
+		if (!IsValid(Pawn)) {
+			RemoveEntry(Index);
+			continue;
+		}
+
+		FGridEntry& Entry = Entries[Index];
+		Entry.Location = Pawn->GetActorLocation();
+		const FIntPoint NewCell = GetCell(Entry.Location);
+		if (NewCell != Entry.Cell) {
+			RemoveFromCell(Entry.Cell, Index);
+			AddToCell(NewCell, Index);
+			Entry.Cell = NewCell;
+		}
+	}
+}
+
+TStatId UCombatGridSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatGridSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatGridSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+template<typename FunctionType>
+void UCombatGridSubsystem::ForEachEntryInRadius(const FVector& Origin, double Radius, FunctionType Function) const {
+	const double RadiusSquared = FMath::Square(Radius);
+	auto VisitCell = [&](const TArray<int32, TInlineAllocator<4>>& CellEntries) {
+		for (const int32 EntryIndex : CellEntries) {
+			const FGridEntry& Entry = Entries[EntryIndex];
+			const double DistSquared = FVector::DistSquared(Origin, Entry.Location);
+			if (DistSquared <= RadiusSquared) {
+				Function(Entry, DistSquared);
+			}
+		}
+	};
+
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius, Radius, 0.0));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius, Radius, 0.0));
+	const int32 NumCellsInRange = (MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1);
+
+	// With only a handful of occupied cells it's cheaper to walk them than to probe every cell in range
+	if (Cells.Num() < NumCellsInRange) {
+		for (const auto& Pair : Cells) {
+			const FIntPoint& Cell = Pair.Key;
+			if (Cell.X >= MinCell.X && Cell.X <= MaxCell.X && Cell.Y >= MinCell.Y && Cell.Y <= MaxCell.Y) {
+				VisitCell(Pair.Value);
+			}
+		}
+		return;
+	}
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y) {
+			if (const TArray<int32, TInlineAllocator<4>>* CellEntries = Cells.Find(FIntPoint(X, Y))) {
+				VisitCell(*CellEntries);
+			}
+		}
+	}
+}
+
+void UCombatGridSubsystem::RegisterTarget(APawn* Target) {
+	if (Target == nullptr || EntryIndices.Contains(Target)) { return; }
+
+	const int32 EntryIndex = Entries.AddDefaulted();
+	FGridEntry& Entry = Entries[EntryIndex];
+	Entry.Pawn = Target;
+	Entry.Key = Target;
+	Entry.Location = Target->GetActorLocation();
+	Entry.Cell = GetCell(Entry.Location);
+	AddToCell(Entry.Cell, EntryIndex);
+	EntryIndices.Add(Target, EntryIndex);
+}
+
+void UCombatGridSubsystem::UnregisterTarget(APawn* Target) {
+	if (const int32* EntryIndex = EntryIndices.Find(Target)) {
+		RemoveEntry(*EntryIndex);
+	}
+}
+
+APawn* UCombatGridSubsystem::FindNearestTargetInView(const FVector& Origin, const FVector& Forward, double Radius, float MinCosAngle) const {
+	APawn* NearestTarget = nullptr;
+	double NearestDistSquared = TNumericLimits<double>::Max();
+	ForEachEntryInRadius(Origin, Radius, [&](const FGridEntry& Entry, double DistSquared) {
+		if (DistSquared >= NearestDistSquared) { return; }
+		const FVector ToTarget = (Entry.Location - Origin).GetSafeNormal();
+		if (FVector::DotProduct(Forward, ToTarget) < MinCosAngle) { return; }
+		NearestTarget = Entry.Pawn.Get();
+		NearestDistSquared = DistSquared;
+	});
+	return NearestTarget;
+}
+
+FIntPoint UCombatGridSubsystem::GetCell(const FVector& Location) const {
+	return FIntPoint(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize)
+	);
+}
+
+void UCombatGridSubsystem::AddToCell(const FIntPoint& Cell, int32 EntryIndex) {
+	Cells.FindOrAdd(Cell).Add(EntryIndex);
+}
+
+void UCombatGridSubsystem::RemoveFromCell(const FIntPoint& Cell, int32 EntryIndex) {
+	if (TArray<int32, TInlineAllocator<4>>* CellEntries = Cells.Find(Cell)) {
+		CellEntries->RemoveSingleSwap(EntryIndex);
+		if (CellEntries->Num() == 0) {
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void UCombatGridSubsystem::RemoveEntry(int32 EntryIndex) {
+	RemoveFromCell(Entries[EntryIndex].Cell, EntryIndex);
+	EntryIndices.Remove(Entries[EntryIndex].Key);
+
+	// The last entry is about to be swapped into EntryIndex, so fix up its cell and index
+	const int32 LastIndex = Entries.Num() - 1;
+	if (EntryIndex != LastIndex) {
+		EntryIndices.Add(Entries[LastIndex].Key, EntryIndex);
+		if (TArray<int32, TInlineAllocator<4>>* CellEntries = Cells.Find(Entries[LastIndex].Cell)) {
+			const int32 Slot = CellEntries->Find(LastIndex);
+			if (Slot != INDEX_NONE) {
+				(*CellEntries)[Slot] = EntryIndex;
+			}
+		}
+	}
+	Entries.RemoveAtSwap(EntryIndex);
+}
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/CombatRangeBatch.h"
+
+void FCombatRangeBatch::SetNum(int32 Num) {
+	X.SetNumUninitialized(Num);
+	Y.SetNumUninitialized(Num);
+	Z.SetNumUninitialized(Num);
+	TargetX.SetNumUninitialized(Num);
+	TargetY.SetNumUninitialized(Num);
+	TargetZ.SetNumUninitialized(Num);
+	AttackRadiusSquared.SetNumUninitialized(Num);
+	CombatRadiusSquared.SetNumUninitialized(Num);
+	Bands.SetNumUninitialized(Num);
+}
+
+void FCombatRangeBatch::SetEntry(int32 Index, const FVector& Location, const FVector& TargetLocation, double AttackRadius, double CombatRadius) {
+	X[Index] = Location.X;
+	Y[Index] = Location.Y;
+	Z[Index] = Location.Z;
+	TargetX[Index] = TargetLocation.X;
+	TargetY[Index] = TargetLocation.Y;
+	TargetZ[Index] = TargetLocation.Z;
+	AttackRadiusSquared[Index] = FMath::Square(AttackRadius);
+	CombatRadiusSquared[Index] = FMath::Square(CombatRadius);
+}
+
+void FCombatRangeBatch::SetEntryNoTarget(int32 Index) {
+	// Negative radii can never contain a distance, so the entry always comes out as outside
+	X[Index] = Y[Index] = Z[Index] = 0.0;
+	TargetX[Index] = TargetY[Index] = TargetZ[Index] = 0.0;
+	AttackRadiusSquared[Index] = -1.0;
+	CombatRadiusSquared[Index] = -1.0;
+}
+
+void FCombatRangeBatch::Classify() {
+	const int32 Count = Bands.Num();
+	const double* RESTRICT PX = X.GetData();
+	const double* RESTRICT PY = Y.GetData();
+	const double* RESTRICT PZ = Z.GetData();
+	const double* RESTRICT PTargetX = TargetX.GetData();
+	const double* RESTRICT PTargetY = TargetY.GetData();
+	const double* RESTRICT PTargetZ = TargetZ.GetData();
+	const double* RESTRICT PAttack = AttackRadiusSquared.GetData();
+	const double* RESTRICT PCombat = CombatRadiusSquared.GetData();
+	uint8* RESTRICT PBands = reinterpret_cast<uint8*>(Bands.GetData());
+
+	for (int32 Index = 0; Index < Count; ++Index) {
+		const double DX = PTargetX[Index] - PX[Index];
+		const double DY = PTargetY[Index] - PY[Index];
+		const double DZ = PTargetZ[Index] - PZ[Index];
+		const double DistSquared = DX * DX + DY * DY + DZ * DZ;
+
+		// Outside the combat radius wins over everything, same as the order AEnemy checks them in
+		const uint8 bOutsideCombat = DistSquared > PCombat[Index];
+		const uint8 bOutsideAttack = DistSquared > PAttack[Index];
+		PBands[Index] = (bOutsideAttack | bOutsideCombat) + bOutsideCombat;
+	}
+}
+
+ECombatRangeBand FCombatRangeBatch::ClassifySingle(const FVector& Location, const FVector& TargetLocation, double AttackRadius, double CombatRadius) {
+	const double DistSquared = FVector::DistSquared(Location, TargetLocation);
+	if (DistSquared > FMath::Square(CombatRadius)) {
+		return ECombatRangeBand::ECRB_Outside;
+	} else if (DistSquared > FMath::Square(AttackRadius)) {
+		return ECombatRangeBand::ECRB_InsideCombat;
+	}
+	return ECombatRangeBand::ECRB_InsideAttack;
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/CombatRules.h"
+#include "Characters/CharacterTypes.h"
+
+/*
+* Attributes
+*/
+float FCombatRules::ApplyDamage(float Health, float MaxHealth, float Damage) {
+	return FMath::Clamp(Health - Damage, 0.f, MaxHealth);
+}
+
+float FCombatRules::SpendStamina(float Stamina, float MaxStamina, float StaminaCost) {
+	return FMath::Clamp(Stamina - StaminaCost, 0.f, MaxStamina);
+}
+
+float FCombatRules::RegenStamina(float Stamina, float MaxStamina, float RegenRate, float DeltaTime) {
+	return FMath::Clamp(Stamina + RegenRate * DeltaTime, 0.f, MaxStamina);
+}
+
+float FCombatRules::RegenHealth(float Health, float MaxHealth, float RegenRate, float DeltaTime) {
+	// The dead stay dead
+	if (!IsAlive(Health)) { return Health; }
+	return FMath::Clamp(Health + RegenRate * DeltaTime, 0.f, MaxHealth);
+}
+
+float FCombatRules::TimeToLimit(float Value, float MaxValue, float RegenRate) {
+	if (RegenRate > 0.f) { return FMath::Max(0.f, (MaxValue - Value) / RegenRate); }
+	if (RegenRate < 0.f) { return FMath::Max(0.f, Value / -RegenRate); }
+	return -1.f;
+}
+
+bool FCombatRules::CanAffordStamina(float Stamina, float StaminaCost) {
+	return Stamina > StaminaCost;
+}
+
+bool FCombatRules::IsAlive(float Health) {
+	return Health > 0.f;
+}
+
+/*
+* Enemy state
+*/
+bool FCombatRules::IsInRange(const FVector& Location, const FVector& TargetLocation, double Radius) {
+	return FVector::DistSquared(TargetLocation, Location) <= FMath::Square(Radius);
+}
+
+ECombatRangeBand FCombatRules::ClassifyCombatRange(const FEnemyAIInput& Input) {
+	if (!Input.bHasCombatTarget) { return ECombatRangeBand::ECRB_Outside; }
+	return FCombatRangeBatch::ClassifySingle(Input.Location, Input.CombatTargetLocation, Input.AttackRadius, Input.CombatRadius);
+}
+
+EEnemyAIDecision FCombatRules::DecideAction(const FEnemyAIInput& Input, ECombatRangeBand CombatRange) {
+	if (Input.EnemyState == EEnemyState::EES_Dead) { return EEnemyAIDecision::EAD_None; }
+	if (Input.EnemyState > EEnemyState::EES_Patrolling) {
+		return DecideCombatAction(Input, CombatRange);
+	}
+	return DecidePatrolAction(Input);
+}
+
+EEnemyAIDecision FCombatRules::DecideCombatAction(const FEnemyAIInput& Input, ECombatRangeBand CombatRange) {
+	if (CombatRange == ECombatRangeBand::ECRB_Outside) {
+		return EEnemyAIDecision::EAD_LoseInterest;
+	} else if (CombatRange == ECombatRangeBand::ECRB_InsideCombat && Input.EnemyState != EEnemyState::EES_Chasing) {
+		return EEnemyAIDecision::EAD_Chase;
+	} else if (CanEnemyAttack(Input.EnemyState, CombatRange == ECombatRangeBand::ECRB_InsideAttack)) {
+		return EEnemyAIDecision::EAD_StartAttack;
+	}
+	return EEnemyAIDecision::EAD_None;
+}
+
+EEnemyAIDecision FCombatRules::DecidePatrolAction(const FEnemyAIInput& Input) {
+	if (Input.bHasPatrolTarget &&
+		FVector::DistSquared(Input.Location, Input.PatrolTargetLocation) <= FMath::Square(Input.PatrolRadius)) {
+		return EEnemyAIDecision::EAD_NextPatrolTarget;
+	}
+	return EEnemyAIDecision::EAD_None;
+}
+
+bool FCombatRules::CanEnemyAttack(EEnemyState EnemyState, bool bInsideAttackRadius) {
+	return bInsideAttackRadius &&
+		EnemyState != EEnemyState::EES_Attacking &&
+		EnemyState != EEnemyState::EES_Engaged &&
+		EnemyState != EEnemyState::EES_Dead;
+}
+
+EEnemyState FCombatRules::EnemyStateWhenDamaged(bool bInsideAttackRadius) {
+	return bInsideAttackRadius ? EEnemyState::EES_Attacking : EEnemyState::EES_Chasing;
+}
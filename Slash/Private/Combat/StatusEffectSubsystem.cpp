@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/StatusEffectSubsystem.h"
+#include "Slash/SlashStats.h"
+#include "Components/AttributeComponent.h"
+#include "Interfaces/HitInterface.h"
+
+DECLARE_CYCLE_STAT(TEXT("Status Effects Update"), STAT_SlashStatusEffectsUpdate, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Status Effects Active"), STAT_SlashStatusEffectsActive, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Status Effect Targets"), STAT_SlashStatusEffectTargets, STATGROUP_Slash);
+
+static TAutoConsoleVariable<float> CVarStatusEffectInterval(
+	TEXT("slash.Effects.Interval"),
+	0.25f,
+	TEXT("Seconds between status effect updates, every active effect advances together on this cadence"));
+
+static TAutoConsoleVariable<int32> CVarStatusEffectMaxStepsPerFrame(
+	TEXT("slash.Effects.MaxStepsPerFrame"),
+	2,
+	TEXT("Most status effect updates run in one frame when catching up after a hitch, the rest of the time is dropped"));
+
+/*
+* Buckets
+*/
+void FStatusEffectBucket::Add(int32 TargetSlot, float InHealthPerSecond, float Duration) {
+	TargetSlots.Add(TargetSlot);
+	HealthPerSecond.Add(InHealthPerSecond);
+	RemainingTimes.Add(Duration);
+}
+
+void FStatusEffectBucket::RemoveAtSwap(int32 Index) {
+	TargetSlots.RemoveAtSwap(Index, 1, false);
+	HealthPerSecond.RemoveAtSwap(Index, 1, false);
+	RemainingTimes.RemoveAtSwap(Index, 1, false);
+}
+
+/*
+* Subsystem
+*/
+void UStatusEffectSubsystem::Tick(float DeltaTime) {
+	SLASH_BENCHMARK_SCOPE(ESBC_Combat);
+	Super::Tick(DeltaTime);
+
+	SLASH_SET_COUNT(StatusEffectsActive, GetNumActiveEffects());
+	SLASH_SET_COUNT(StatusEffectTargets, TargetSlotLookup.Num());
+	if (TargetSlotLookup.Num() == 0) {
+		StepAccumulator = 0.f;
+		return;
+	}
+
+	const float StepTime = FMath::Max(0.01f, CVarStatusEffectInterval.GetValueOnGameThread());
+	const int32 MaxSteps = FMath::Max(1, CVarStatusEffectMaxStepsPerFrame.GetValueOnGameThread());
+	StepAccumulator += DeltaTime;
+	int32 NumSteps = 0;
+	while (StepAccumulator >= StepTime && NumSteps < MaxSteps) {
+		StepAccumulator -= StepTime;
+		StepEffects(StepTime);
+		++NumSteps;
+	}
+	// Don't let a long hitch turn into a burst of catch up steps over the next frames
+	StepAccumulator = FMath::Min(StepAccumulator, StepTime);
+}
+
+TStatId UStatusEffectSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStatusEffectSubsystem, STATGROUP_Tickables);
+}
+
+bool UStatusEffectSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UStatusEffectSubsystem::ApplyEffect(UAttributeComponent* Target, EStatusEffectType Type, float Magnitude, float Duration) {
+	if (Target == nullptr || Type == EStatusEffectType::ESE_MAX || Duration <= 0.f || Magnitude == 0.f) { return; }
+
+	const float Sign = Type == EStatusEffectType::ESE_Regen ? 1.f : -1.f;
+	Buckets[(uint8)Type].Add(AcquireTargetSlot(Target), Sign * FMath::Abs(Magnitude), Duration);
+}
+
+void UStatusEffectSubsystem::ClearEffects(UAttributeComponent* Target) {
+	const int32* TargetSlot = TargetSlotLookup.Find(Target);
+	if (TargetSlot == nullptr) { return; }
+
+	const int32 Slot = *TargetSlot;
+	for (FStatusEffectBucket& Bucket : Buckets) {
+		for (int32 Index = Bucket.Num() - 1; Index >= 0; --Index) {
+			if (Bucket.TargetSlots[Index] == Slot) {
+				Bucket.RemoveAtSwap(Index);
+				ReleaseTargetSlot(Slot);
+			}
+		}
+	}
+}
+
+int32 UStatusEffectSubsystem::GetNumActiveEffects() const {
+	int32 NumEffects = 0;
+	for (const FStatusEffectBucket& Bucket : Buckets) {
+		NumEffects += Bucket.Num();
+	}
+	return NumEffects;
+}
+
+void UStatusEffectSubsystem::StepEffects(float StepTime) {
+	SLASH_SCOPE_HOT_PATH(StatusEffectsUpdate);
+	FMemory::Memzero(TargetHealthDeltas.GetData(), TargetHealthDeltas.Num() * sizeof(float));
+
+	float* RESTRICT Deltas = TargetHealthDeltas.GetData();
+	for (FStatusEffectBucket& Bucket : Buckets) {
+		const int32 NumEffects = Bucket.Num();
+		const int32* RESTRICT Slots = Bucket.TargetSlots.GetData();
+		const float* RESTRICT Rates = Bucket.HealthPerSecond.GetData();
+		float* RESTRICT Remaining = Bucket.RemainingTimes.GetData();
+
+		// Straight pass over the arrays, an effect ending mid step only counts the time it had left
+		for (int32 Index = 0; Index < NumEffects; ++Index) {
+			const float ActiveTime = FMath::Min(Remaining[Index], StepTime);
+			Deltas[Slots[Index]] += Rates[Index] * ActiveTime;
+			Remaining[Index] -= StepTime;
+		}
+	}
+
+	// Apply before removing, an effect's last tick still needs its target's slot
+	ApplyHealthDeltas();
+	RemoveExpiredEffects();
+}
+
+void UStatusEffectSubsystem::RemoveExpiredEffects() {
+	for (FStatusEffectBucket& Bucket : Buckets) {
+		for (int32 Index = Bucket.Num() - 1; Index >= 0; --Index) {
+			if (Bucket.RemainingTimes[Index] <= 0.f) {
+				const int32 Slot = Bucket.TargetSlots[Index];
+				Bucket.RemoveAtSwap(Index);
+				ReleaseTargetSlot(Slot);
+			}
+		}
+	}
+}
+
+void UStatusEffectSubsystem::ApplyHealthDeltas() {
+	for (int32 Slot = 0; Slot < Targets.Num(); ++Slot) {
+		const float Delta = TargetHealthDeltas[Slot];
+		if (Delta == 0.f) { continue; }
+		UAttributeComponent* Target = Targets[Slot].Get();
+		if (Target == nullptr || !Target->IsAlive()) { continue; }
+
+		Target->ApplyHealthDelta(Delta);
+		// Killing blow goes through GetHit like a weapon kill, so the usual death path runs
+		if (!Target->IsAlive()) {
+			AActor* Owner = Target->GetOwner();
+			if (Owner && Owner->Implements<UHitInterface>()) {
+				IHitInterface::Execute_GetHit(Owner, Owner->GetActorLocation(), nullptr);
+			}
+		}
+	}
+}
+
+int32 UStatusEffectSubsystem::AcquireTargetSlot(UAttributeComponent* Target) {
+	if (const int32* ExistingSlot = TargetSlotLookup.Find(Target)) {
+		++TargetEffectCounts[*ExistingSlot];
+		return *ExistingSlot;
+	}
+
+	int32 Slot;
+	if (FreeTargetSlots.Num() > 0) {
+		Slot = FreeTargetSlots.Pop(false);
+		Targets[Slot] = Target;
+		TargetKeys[Slot] = Target;
+		TargetEffectCounts[Slot] = 1;
+	} else {
+		Slot = Targets.Add(Target);
+		TargetKeys.Add(Target);
+		TargetHealthDeltas.Add(0.f);
+		TargetEffectCounts.Add(1);
+	}
+	TargetSlotLookup.Add(Target, Slot);
+	return Slot;
+}
+
+void UStatusEffectSubsystem::ReleaseTargetSlot(int32 TargetSlot) {
+	if (--TargetEffectCounts[TargetSlot] > 0) { return; }
+
+	// The key still works when the target itself is already gone
+	TargetSlotLookup.Remove(TargetKeys[TargetSlot]);
+	TargetKeys[TargetSlot] = TObjectKey<UAttributeComponent>();
+	Targets[TargetSlot].Reset();
+	FreeTargetSlots.Add(TargetSlot);
+}
@@ -2,6 +2,7 @@
 
 
 #include "Components/AttributeComponent.h"
+#include "Combat/CombatRules.h"
 
 // Sets default values for this component's properties
 UAttributeComponent::UAttributeComponent(){
@@ -12,39 +13,109 @@ UAttributeComponent::UAttributeComponent(){
 // Called when the game starts
 void UAttributeComponent::BeginPlay(){
 	Super::BeginPlay();
-	
+
+	HealthTimestamp = StaminaTimestamp = GetNow();
+}
+
+double UAttributeComponent::GetNow() const {
+	const UWorld* World = GetWorld();
+	return World ? World->GetTimeSeconds() : 0.0;
 }
 
-void UAttributeComponent::RegenStamina(float DeltaTime) {
-	Stamina = FMath::Clamp(Stamina + StaminaRegenRate * DeltaTime, 0.f, MaxStamina);
+void UAttributeComponent::SettleHealth() {
+	Health = GetHealth();
+	HealthTimestamp = GetNow();
+}
+
+void UAttributeComponent::SettleStamina() {
+	Stamina = GetStamina();
+	StaminaTimestamp = GetNow();
 }
 
 void UAttributeComponent::ReceiveDamage(float Damage) {
-	Health = FMath::Clamp(Health - Damage, 0.f, MaxHealth);
+	SettleHealth();
+	const float OldHealth = Health;
+	Health = FCombatRules::ApplyDamage(Health, MaxHealth, Damage);
+	BroadcastChange(EAttributeType::EAT_Health, OldHealth, Health);
+}
+
+void UAttributeComponent::ApplyHealthDelta(float Delta) {
+	SettleHealth();
+	if (Delta > 0.f && !FCombatRules::IsAlive(Health)) { return; }
+	const float OldHealth = Health;
+	Health = FCombatRules::ApplyDamage(Health, MaxHealth, -Delta);
+	BroadcastChange(EAttributeType::EAT_Health, OldHealth, Health);
 }
 
 void UAttributeComponent::UseStamina(float StaminaCost) {
-	Stamina = FMath::Clamp(Stamina - StaminaCost, 0.f, MaxStamina);
+	SettleStamina();
+	const float OldStamina = Stamina;
+	Stamina = FCombatRules::SpendStamina(Stamina, MaxStamina, StaminaCost);
+	BroadcastChange(EAttributeType::EAT_Stamina, OldStamina, Stamina);
+}
+
+void UAttributeComponent::ResetAttributes() {
+	const float OldHealth = GetHealth();
+	const float OldStamina = GetStamina();
+	Health = MaxHealth;
+	Stamina = MaxStamina;
+	HealthTimestamp = StaminaTimestamp = GetNow();
+	BroadcastChange(EAttributeType::EAT_Health, OldHealth, Health);
+	BroadcastChange(EAttributeType::EAT_Stamina, OldStamina, Stamina);
+}
+
+void UAttributeComponent::BroadcastChange(EAttributeType Attribute, float OldValue, float NewValue) {
+	if (OldValue != NewValue) {
+		OnAttributeChanged.Broadcast(Attribute, OldValue, NewValue);
+	}
+}
+
+float UAttributeComponent::GetHealth() const {
+	return FCombatRules::RegenHealth(Health, MaxHealth, HealthRegenRate, GetNow() - HealthTimestamp);
+}
+
+float UAttributeComponent::GetStamina() const {
+	return FCombatRules::RegenStamina(Stamina, MaxStamina, StaminaRegenRate, GetNow() - StaminaTimestamp);
 }
 
 float UAttributeComponent::GetHealthPercent() {
-	return Health / MaxHealth;
+	return GetHealth() / MaxHealth;
 }
 
 float UAttributeComponent::GetStaminaPercent() {
-	return Stamina / MaxStamina;
+	return GetStamina() / MaxStamina;
 }
 
 bool UAttributeComponent::IsAlive() {
-	return Health > 0.f;
+	// Regen can't bring anyone back, so the stored value is enough
+	return FCombatRules::IsAlive(Health);
+}
+
+double UAttributeComponent::GetHealthLimitTime() const {
+	// Dead health doesn't regenerate
+	if (!FCombatRules::IsAlive(Health)) { return -1.0; }
+	return GetLimitTime(GetHealth(), MaxHealth, HealthRegenRate);
+}
+
+double UAttributeComponent::GetStaminaLimitTime() const {
+	return GetLimitTime(GetStamina(), MaxStamina, StaminaRegenRate);
+}
+
+double UAttributeComponent::GetLimitTime(float Value, float MaxValue, float RegenRate) const {
+	const float TimeToLimit = FCombatRules::TimeToLimit(Value, MaxValue, RegenRate);
+	return TimeToLimit < 0.f ? -1.0 : GetNow() + TimeToLimit;
 }
 
 void UAttributeComponent::AddSouls(int32 NumOfSouls) {
+	const int32 OldSouls = Souls;
 	Souls += NumOfSouls;
+	BroadcastChange(EAttributeType::EAT_Souls, OldSouls, Souls);
 }
 
 void UAttributeComponent::AddGold(int32 AmountOfGold) {
+	const int32 OldGold = Gold;
 	Gold += AmountOfGold;
+	BroadcastChange(EAttributeType::EAT_Gold, OldGold, Gold);
 }
 
 // Called every frame
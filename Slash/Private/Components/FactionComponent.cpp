@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/FactionComponent.h"
+#include "Characters/BaseCharacter.h"
+
+namespace FactionTags {
+	static const FName Enemy(TEXT("Enemy"));
+	static const FName Dead(TEXT("Dead"));
+	static const FName Engageable(TEXT("EngageableTarget"));
+}
+
+UFactionComponent::UFactionComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UFactionComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Tags set on the Blueprint still count, then make sure the tags match whatever we started with
+	ReadLegacyTags();
+	SyncLegacyTags(GetFlags());
+}
+
+void UFactionComponent::AddFlags(EFactionFlags FlagsToAdd) {
+	const EFactionFlags Changed = FlagsToAdd & ~GetFlags();
+	if (Changed == EFactionFlags::EFF_None) { return; }
+	Flags |= static_cast<uint8>(Changed);
+	SyncLegacyTags(Changed);
+}
+
+void UFactionComponent::RemoveFlags(EFactionFlags FlagsToRemove) {
+	const EFactionFlags Changed = FlagsToRemove & GetFlags();
+	if (Changed == EFactionFlags::EFF_None) { return; }
+	Flags &= ~static_cast<uint8>(Changed);
+	SyncLegacyTags(Changed);
+}
+
+bool UFactionComponent::IsSameTeam(const UFactionComponent* Other) const {
+	// Only enemies hold back on each other, the player is always fair game
+	return Other && HasAnyFlags(EFactionFlags::EFF_Enemy) && Other->HasAnyFlags(EFactionFlags::EFF_Enemy);
+}
+
+UFactionComponent* UFactionComponent::FindFaction(const AActor* Actor) {
+	const ABaseCharacter* Character = Cast<ABaseCharacter>(Actor);
+	return Character ? Character->GetFaction() : nullptr;
+}
+
+bool UFactionComponent::ActorHasFlags(const AActor* Actor, EFactionFlags FlagsToCheck) {
+	const UFactionComponent* Faction = FindFaction(Actor);
+	return Faction && Faction->HasAllFlags(FlagsToCheck);
+}
+
+void UFactionComponent::ReadLegacyTags() {
+	const AActor* Owner = GetOwner();
+	if (Owner == nullptr) { return; }
+	if (Owner->ActorHasTag(FactionTags::Enemy)) { Flags |= static_cast<uint8>(EFactionFlags::EFF_Enemy); }
+	if (Owner->ActorHasTag(FactionTags::Dead)) { Flags |= static_cast<uint8>(EFactionFlags::EFF_Dead); }
+	if (Owner->ActorHasTag(FactionTags::Engageable)) { Flags |= static_cast<uint8>(EFactionFlags::EFF_Engageable); }
+}
+
+void UFactionComponent::SyncLegacyTags(EFactionFlags ChangedFlags) {
+	AActor* Owner = GetOwner();
+	if (Owner == nullptr) { return; }
+
+	auto SyncTag = [this, Owner, ChangedFlags](EFactionFlags Flag, const FName& Tag) {
+		if (!EnumHasAnyFlags(ChangedFlags, Flag)) { return; }
+		if (HasAnyFlags(Flag)) {
+			Owner->Tags.AddUnique(Tag);
+		} else {
+			Owner->Tags.Remove(Tag);
+		}
+	};
+	SyncTag(EFactionFlags::EFF_Enemy, FactionTags::Enemy);
+	SyncTag(EFactionFlags::EFF_Dead, FactionTags::Dead);
+	SyncTag(EFactionFlags::EFF_Engageable, FactionTags::Engageable);
+}
@@ -2,19 +2,34 @@
 
 
 #include "Enemy/Enemy.h"
+#include "Enemy/EnemyAISubsystem.h"
+#include "Enemy/PatrolRoute.h"
+#include "Enemy/EnemyMoveScheduler.h"
+#include "Enemy/EnemyPoolSubsystem.h"
+#include "Combat/CombatGridSubsystem.h"
+#include "Combat/CombatRules.h"
+#include "Slash/SlashStats.h"
 #include "AIController.h"
 #include "Items/Weapons/Weapon.h"
 #include "Items/Soul.h"
+#include "Items/PickupPoolSubsystem.h"
+#include "Items/LootRegistrySubsystem.h"
 
 /* Components */
 #include "HUD/HealthBarComponent.h"
 #include "Components/AttributeComponent.h"
+#include "Components/FactionComponent.h"
 #include "Perception/PawnSensingComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Components/CapsuleComponent.h"
 #include "Navigation/PathFollowingComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Enemy/EnemyMovementComponent.h"
 
-AEnemy::AEnemy()
+DECLARE_CYCLE_STAT(TEXT("Enemy Tick"), STAT_SlashEnemyTick, STATGROUP_Slash);
+
+AEnemy::AEnemy(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UEnemyMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -38,26 +53,29 @@ AEnemy::AEnemy()
 	PawnSensing = CreateDefaultSubobject<UPawnSensingComponent>(TEXT("PawnSensing"));
 	PawnSensing->SightRadius = 4000.f;
 	PawnSensing->SetPeripheralVisionAngle(45.f);
+
+	// Pooled and wave spawned enemies need a controller too, not just placed ones
+	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
 }
 
 void AEnemy::Tick(float DeltaTime) {
+	SLASH_SCOPE_HOT_PATH(EnemyTick);
+	SLASH_BENCHMARK_SCOPE(ESBC_AI);
 	Super::Tick(DeltaTime);
 
-	if (IsDead()) { return; }
-	if (EnemyState > EEnemyState::EES_Patrolling) {
-		CheckCombatTarget();
-	} else {
-		CheckPatrolTarget();
-	}
+	// Only reached when no UEnemyAISubsystem is driving this enemy
+	FEnemyAIInput Input;
+	GatherAIInput(Input);
+	ExecuteAIDecision(FCombatRules::DecideAction(Input, FCombatRules::ClassifyCombatRange(Input)));
 }
 
 float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) {
 	HandleDamage(DamageAmount);
 	CombatTarget = EventInstigator->GetPawn();
+	bAIPromoted = true;
 	
-	if (IsInsideAttackRadius()) {
-		EnemyState = EEnemyState::EES_Attacking;
-	} else if (IsOutsideAttackRadius()){
+	EnemyState = FCombatRules::EnemyStateWhenDamaged(IsInsideAttackRadius());
+	if (EnemyState == EEnemyState::EES_Chasing) {
 		ChaseTarget();
 	}
 
@@ -70,6 +88,18 @@ void AEnemy::Destroyed() {
 	}
 }
 
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UWorld* World = GetWorld()) {
+		if (UEnemyAISubsystem* EnemyAI = World->GetSubsystem<UEnemyAISubsystem>()) {
+			EnemyAI->UnregisterEnemy(this);
+		}
+		if (UEnemyMoveScheduler* MoveScheduler = World->GetSubsystem<UEnemyMoveScheduler>()) {
+			MoveScheduler->CancelMoves(this);
+		}
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
 void AEnemy::GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter) {
 	Super::GetHit_Implementation(ImpactPoint, Hitter);
 	if(!IsDead()) ShowHealthBar();
@@ -93,7 +123,22 @@ void AEnemy::BeginPlay()
 	}
 	InitializeEnemy();
 
-	Tags.Add(FName("Enemy"));
+	Faction->AddFlags(EFactionFlags::EFF_Enemy);
+	RegisterWithAI();
+}
+
+void AEnemy::RegisterWithAI() {
+	// Let the subsystem run our AI in its batched pass, no need for our own tick
+	if (UEnemyAISubsystem* EnemyAI = GetWorld()->GetSubsystem<UEnemyAISubsystem>()) {
+		EnemyAI->RegisterEnemy(this);
+		SetActorTickEnabled(false);
+
+		// Sight candidates come from the combat grid, PawnSensing would just poll every pawn again
+		if (PawnSensing && GetWorld()->GetSubsystem<UCombatGridSubsystem>()) {
+			PawnSensing->SetSensingUpdatesEnabled(false);
+			bUseGridSensing = true;
+		}
+	}
 }
 
 /* 
@@ -105,16 +150,95 @@ void AEnemy::Die_Implementation() {
 	ClearAttackTimer();
 	HideHealthBar();
 	DisableCapsule();
-	SetLifeSpan(DeathLifeSpan);
+	UEnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>();
+	if (EnemyPool && EnemyPool->IsPoolingEnabled()) {
+		EnemyPool->AddCorpse(this, DeathLifeSpan);
+	} else {
+		SetLifeSpan(DeathLifeSpan);
+	}
 	SetWeaponCollision(ECollisionEnabled::NoCollision);
 	SpawnSoul();
 }
 
+/*
+* Pooling
+*/
+void AEnemy::DeactivateToPool() {
+	UWorld* World = GetWorld();
+	if (UEnemyAISubsystem* EnemyAI = World->GetSubsystem<UEnemyAISubsystem>()) {
+		EnemyAI->UnregisterEnemy(this);
+	}
+	if (UEnemyMoveScheduler* MoveScheduler = World->GetSubsystem<UEnemyMoveScheduler>()) {
+		MoveScheduler->CancelMoves(this);
+	}
+	if (EnemyController) {
+		EnemyController->StopMovement();
+	}
+	ClearPatrolTimer();
+	ClearAttackTimer();
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	GetMesh()->SetComponentTickEnabled(false);
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	if (EquippedWeapon) {
+		EquippedWeapon->SetActorHiddenInGame(true);
+	}
+}
+
+void AEnemy::ReactivateFromPool(const FTransform& SpawnTransform, APatrolRoute* NewPatrolRoute) {
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+	SetPatrolRoute(NewPatrolRoute);
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	GetMesh()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->MaxWalkSpeed = PatrollingSpeed;
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance()) {
+		AnimInstance->StopAllMontages(0.f);
+	}
+
+	// Back to how BeginPlay left us
+	Faction->RemoveFlags(EFactionFlags::EFF_Dead);
+	EnemyState = EEnemyState::EES_Patrolling;
+	CombatTarget = nullptr;
+	bAIPromoted = false;
+	NextSightTime = 0.0;
+	if (Attributes) {
+		Attributes->ResetAttributes();
+	}
+	HideHealthBar();
+
+	if (EquippedWeapon) {
+		EquippedWeapon->SetActorHiddenInGame(false);
+	}
+	SetWeaponCollision(ECollisionEnabled::NoCollision);
+
+	RegisterWithAI();
+	MoveToPatrolTarget();
+}
+
+void AEnemy::SetPatrolRoute(APatrolRoute* NewPatrolRoute) {
+	if (NewPatrolRoute == nullptr) { return; }
+	PatrolRoute = NewPatrolRoute;
+	PatrolWaypoint = PatrolRoute->FindNearestWaypoint(GetActorLocation());
+}
+
 void AEnemy::SpawnSoul() {
 	UWorld* World = GetWorld();
 	if (World && SoulClass && Attributes) {
 		const FVector SpawnLocation = GetActorLocation() + FVector(0.f, 0.f, 25.f);
-		ASoul* SpawnedSoul = World->SpawnActor<ASoul>(SoulClass, GetActorLocation(), GetActorRotation());
+		// Only spawns an actor if a player is close enough to see it, otherwise the registry just keeps the souls
+		if (ULootRegistrySubsystem* LootRegistry = World->GetSubsystem<ULootRegistrySubsystem>()) {
+			LootRegistry->DropLoot(SoulClass, FTransform(GetActorRotation(), GetActorLocation()), Attributes->GetSouls());
+			return;
+		}
+		UPickupPoolSubsystem* PickupPool = World->GetSubsystem<UPickupPoolSubsystem>();
+		ASoul* SpawnedSoul = PickupPool ?
+			PickupPool->SpawnPickup<ASoul>(SoulClass, GetActorLocation(), GetActorRotation()) :
+			World->SpawnActor<ASoul>(SoulClass, GetActorLocation(), GetActorRotation());
 		if (SpawnedSoul) {
 			SpawnedSoul->SetSouls(Attributes->GetSouls());
 		} else {
@@ -127,29 +251,20 @@ void AEnemy::Attack() {
 	Super::Attack();
 	if (CombatTarget == nullptr) { return; }
 	EnemyState = EEnemyState::EES_Engaged;
+	SLASH_COMBAT_EVENT(AttackStart, this);
 	PlayAttackMontage();
 }
 
 bool AEnemy::CanAttack() {
-	return IsInsideAttackRadius() && 
-		!IsAttacking() && 
-		!IsEngaged() &&
-		!IsDead();;
+	return FCombatRules::CanEnemyAttack(EnemyState, IsInsideAttackRadius());
 }
 
 void AEnemy::AttackEnd() {
+	Super::AttackEnd();
 	EnemyState = EEnemyState::EES_NoState;
 	CheckCombatTarget();
 }
 
-void AEnemy::HandleDamage(float DamageAmount) {
-	Super::HandleDamage(DamageAmount);
-
-	if (HealthBarWidget) {
-		HealthBarWidget->SetHealthPercent(Attributes->GetHealthPercent());
-	}
-}
-
 int32 AEnemy::PlayAttackMontage() {
 	return Super::PlayAttackMontage();
 }
@@ -159,35 +274,84 @@ int32 AEnemy::PlayAttackMontage() {
 */
 void AEnemy::InitializeEnemy() {
 	EnemyController = Cast<AAIController>(GetController());
-	MoveToTarget(PatrolTarget);
+	if (HealthBarWidget) {
+		HealthBarWidget->BindAttributes(Attributes);
+	}
+	MoveToPatrolTarget();
 	HideHealthBar();
 	SpawnDefaultWeapon();
 }
 
 void AEnemy::CheckPatrolTarget() {
-	if (InTargetRange(PatrolTarget, PatrolRadius)) {
-		PatrolTarget = ChoosePatrolTarget();
-		const float WaitTime = FMath::RandRange(PatrolWaitMin, PatrolWaitMax);
-		GetWorldTimerManager().SetTimer(PatrolTimer, this, &AEnemy::PatrolTimerFinished, WaitTime);
-	}
+	FEnemyAIInput Input;
+	GatherAIInput(Input);
+	ExecuteAIDecision(FCombatRules::DecidePatrolAction(Input));
 }
 
 void AEnemy::CheckCombatTarget() {
-	if (IsOutsideCombatRadius()) {
+	FEnemyAIInput Input;
+	GatherAIInput(Input);
+	ExecuteAIDecision(FCombatRules::DecideCombatAction(Input, FCombatRules::ClassifyCombatRange(Input)));
+}
+
+void AEnemy::GatherAIInput(FEnemyAIInput& OutInput) const {
+	OutInput.Location = GetActorLocation();
+	OutInput.EnemyState = EnemyState;
+	OutInput.CombatRadius = CombatRadius;
+	OutInput.AttackRadius = AttackRadius;
+	OutInput.PatrolRadius = PatrolRadius;
+	OutInput.bHasCombatTarget = CombatTarget != nullptr;
+	if (CombatTarget) {
+		OutInput.CombatTargetLocation = CombatTarget->GetActorLocation();
+	}
+	if (PatrolRoute) {
+		OutInput.bHasPatrolTarget = PatrolWaypoint >= 0 && PatrolWaypoint < PatrolRoute->GetNumWaypoints();
+		if (OutInput.bHasPatrolTarget) {
+			OutInput.PatrolTargetLocation = PatrolRoute->GetWaypointLocation(PatrolWaypoint);
+		}
+	} else {
+		OutInput.bHasPatrolTarget = PatrolTarget != nullptr;
+		if (PatrolTarget) {
+			OutInput.PatrolTargetLocation = PatrolTarget->GetActorLocation();
+		}
+	}
+	OutInput.bWantsSight = bUseGridSensing &&
+		EnemyState == EEnemyState::EES_Patrolling &&
+		GetWorld()->GetTimeSeconds() >= NextSightTime;
+	if (OutInput.bWantsSight) {
+		OutInput.Forward = GetActorForwardVector();
+		OutInput.SightRadius = PawnSensing->SightRadius;
+		OutInput.PeripheralVisionCosine = PawnSensing->GetPeripheralVisionCosine();
+	}
+}
+
+void AEnemy::ExecuteAIDecision(EEnemyAIDecision Decision) {
+	switch (Decision) {
+	case EEnemyAIDecision::EAD_NextPatrolTarget: {
+		ChoosePatrolTarget();
+		const float WaitTime = FMath::RandRange(PatrolWaitMin, PatrolWaitMax);
+		GetWorldTimerManager().SetTimer(PatrolTimer, this, &AEnemy::PatrolTimerFinished, WaitTime);
+		break;
+	}
+	case EEnemyAIDecision::EAD_LoseInterest:
 		ClearAttackTimer();
 		LoseInterest();
 		if (!IsEngaged()) { StartPatrolling(); }
-	} else if (IsOutsideAttackRadius() && !IsChasing()) {
+		break;
+	case EEnemyAIDecision::EAD_Chase:
 		ClearAttackTimer();
 		if (!IsEngaged()) { ChaseTarget(); }
-	} else if (CanAttack()) {
+		break;
+	case EEnemyAIDecision::EAD_StartAttack:
 		StartAttackTimer();
+		break;
+	default:
+		break;
 	}
-
 }
 
 void AEnemy::PatrolTimerFinished() {
-	MoveToTarget(PatrolTarget);
+	MoveToPatrolTarget();
 }
 
 void AEnemy::ClearPatrolTimer() {
@@ -214,7 +378,7 @@ void AEnemy::LoseInterest() {
 void AEnemy::StartPatrolling() {
 	EnemyState = EEnemyState::EES_Patrolling;
 	GetCharacterMovement()->MaxWalkSpeed = PatrollingSpeed;
-	MoveToTarget(PatrolTarget);
+	MoveToPatrolTarget();
 }
 
 void AEnemy::ChaseTarget() {
@@ -223,26 +387,10 @@ void AEnemy::ChaseTarget() {
 	MoveToTarget(CombatTarget);
 }
 
-bool AEnemy::IsOutsideCombatRadius() {
-	return !InTargetRange(CombatTarget, CombatRadius);
-}
-
-bool AEnemy::IsOutsideAttackRadius() {
-	return !InTargetRange(CombatTarget, AttackRadius);
-}
-
 bool AEnemy::IsInsideAttackRadius() {
 	return InTargetRange(CombatTarget, AttackRadius);
 }
 
-bool AEnemy::IsChasing() {
-	return EnemyState == EEnemyState::EES_Chasing;
-}
-
-bool AEnemy::IsAttacking() {
-	return EnemyState == EEnemyState::EES_Attacking;
-}
-
 bool AEnemy::IsDead() {
 	return EnemyState == EEnemyState::EES_Dead;
 }
@@ -263,32 +411,75 @@ void AEnemy::ClearAttackTimer() {
 
 bool AEnemy::InTargetRange(AActor* Target, double Radius) {
 	if (Target == nullptr) return false;
-	const double DistanceToTarget = (Target->GetActorLocation() - GetActorLocation()).Size();
-	return DistanceToTarget <= Radius;
+	return FCombatRules::IsInRange(GetActorLocation(), Target->GetActorLocation(), Radius);
 }
 
 void AEnemy::MoveToTarget(AActor* Target) {
 	if(EnemyController == nullptr || Target == nullptr) return;
+	RequestMove(Target, Target->GetActorLocation());
+}
+
+void AEnemy::MoveToLocation(const FVector& Location) {
+	if (EnemyController == nullptr) return;
+	RequestMove(nullptr, Location);
+}
+
+void AEnemy::RequestMove(AActor* GoalActor, const FVector& GoalLocation) {
+	// Let the scheduler spread pathfinding out over frames when there is one
+	if (UEnemyMoveScheduler* MoveScheduler = GetWorld()->GetSubsystem<UEnemyMoveScheduler>()) {
+		const EEnemyMoveUrgency Urgency = EnemyState > EEnemyState::EES_Patrolling ? EEnemyMoveUrgency::EMU_Chase : EEnemyMoveUrgency::EMU_Patrol;
+		MoveScheduler->RequestMove(this, GoalActor, GoalLocation, AcceptanceRadius, Urgency);
+		return;
+	}
+
 	FAIMoveRequest MoveRequest;
-	MoveRequest.SetGoalActor(Target);
+	if (GoalActor) {
+		MoveRequest.SetGoalActor(GoalActor);
+	} else {
+		MoveRequest.SetGoalLocation(GoalLocation);
+	}
 	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
 	EnemyController->MoveTo(MoveRequest);
 }
 
-AActor* AEnemy::ChoosePatrolTarget() {
-	TArray<AActor*> ValidTargets;
-	for (AActor* Target : PatrolTargets) {
-		if (Target != PatrolTarget) {
-			ValidTargets.AddUnique(Target);
+void AEnemy::MoveToPatrolTarget() {
+	if (PatrolRoute) {
+		if (PatrolWaypoint >= 0 && PatrolWaypoint < PatrolRoute->GetNumWaypoints()) {
+			MoveToLocation(PatrolRoute->GetWaypointLocation(PatrolWaypoint));
 		}
+	} else {
+		MoveToTarget(PatrolTarget);
+	}
+}
+
+void AEnemy::ChoosePatrolTarget() {
+	if (PatrolRoute) {
+		PatrolWaypoint = PatrolRoute->ChooseNextWaypoint(PatrolWaypoint);
+		return;
+	}
+
+	// Pick the Nth target that isn't the current one, no scratch array needed. A target listed twice
+	// only counts the first time, so it isn't picked more often
+	auto IsValidTarget = [this](int32 Index) {
+		AActor* Target = PatrolTargets[Index];
+		return Target != PatrolTarget && PatrolTargets.IndexOfByKey(Target) == Index;
+	};
+	int32 NumValidTargets = 0;
+	for (int32 Index = 0; Index < PatrolTargets.Num(); ++Index) {
+		if (IsValidTarget(Index)) { ++NumValidTargets; }
+	}
+	if (NumValidTargets == 0) {
+		PatrolTarget = nullptr;
+		return;
 	}
-	const int32 NumPatrolTargets = ValidTargets.Num();
 
-	if (NumPatrolTargets > 0) {
-		const int32 TargetSelection = FMath::RandRange(0, NumPatrolTargets - 1);
-		return ValidTargets[TargetSelection];
+	int32 TargetSelection = FMath::RandRange(0, NumValidTargets - 1);
+	for (int32 Index = 0; Index < PatrolTargets.Num(); ++Index) {
+		if (IsValidTarget(Index) && TargetSelection-- == 0) {
+			PatrolTarget = PatrolTargets[Index];
+			return;
+		}
 	}
-	return nullptr;
 }
 
 void AEnemy::SpawnDefaultWeapon() {
@@ -300,13 +491,30 @@ void AEnemy::SpawnDefaultWeapon() {
 	}
 }
 
+bool AEnemy::ConsumeAIPromotion() {
+	const bool bWasPromoted = bAIPromoted;
+	bAIPromoted = false;
+	return bWasPromoted;
+}
+
+void AEnemy::SenseTarget(APawn* SeenPawn) {
+	// Grid only tells us who's in range and in view, still need line of sight like PawnSensing does
+	NextSightTime = GetWorld()->GetTimeSeconds() + PawnSensing->SensingInterval;
+	if (EnemyController && EnemyController->LineOfSightTo(SeenPawn)) {
+		PawnSeen(SeenPawn);
+	}
+}
+
 void AEnemy::PawnSeen(APawn* SeenPawn) {
+	const UFactionComponent* SeenFaction = UFactionComponent::FindFaction(SeenPawn);
 	const bool bShouldChaseTarget =
 		EnemyState == EEnemyState::EES_Patrolling &&
-		SeenPawn->ActorHasTag(FName("EngageableTarget")) &&
-		!SeenPawn->ActorHasTag(FName("Dead"));
+		SeenFaction &&
+		SeenFaction->HasAnyFlags(EFactionFlags::EFF_Engageable) &&
+		!SeenFaction->IsDead();
 
 	if (bShouldChaseTarget) {
+		bAIPromoted = true;
 		CombatTarget = SeenPawn;
 		ClearPatrolTimer();
 		ChaseTarget();
@@ -0,0 +1,244 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/EnemyAISubsystem.h"
+#include "Enemy/Enemy.h"
+#include "Slash/SlashStats.h"
+#include "Combat/CombatGridSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies in Near LOD"), STAT_SlashEnemiesNearLOD, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies in Mid LOD"), STAT_SlashEnemiesMidLOD, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies in Far LOD"), STAT_SlashEnemiesFarLOD, STATGROUP_Slash);
+DECLARE_CYCLE_STAT(TEXT("Enemy AI"), STAT_SlashEnemyAI, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Idle"), STAT_SlashEnemiesIdle, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Patrolling"), STAT_SlashEnemiesPatrolling, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Chasing"), STAT_SlashEnemiesChasing, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Attacking"), STAT_SlashEnemiesAttacking, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Engaged"), STAT_SlashEnemiesEngaged, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Dead"), STAT_SlashEnemiesDead, STATGROUP_Slash);
+
+static TAutoConsoleVariable<float> CVarEnemyAIMidDistance(
+	TEXT("slash.AI.LOD.MidDistance"),
+	3000.f,
+	TEXT("Distance from the nearest player beyond which enemies drop to the mid AI LOD"));
+
+static TAutoConsoleVariable<float> CVarEnemyAIFarDistance(
+	TEXT("slash.AI.LOD.FarDistance"),
+	6000.f,
+	TEXT("Distance from the nearest player beyond which enemies drop to the far AI LOD"));
+
+static TAutoConsoleVariable<int32> CVarEnemyAIMidInterval(
+	TEXT("slash.AI.LOD.MidInterval"),
+	4,
+	TEXT("Enemies in the mid AI LOD re-evaluate their AI every N frames"));
+
+static TAutoConsoleVariable<int32> CVarEnemyAIFarInterval(
+	TEXT("slash.AI.LOD.FarInterval"),
+	16,
+	TEXT("Enemies in the far AI LOD re-evaluate their AI every N frames"));
+
+void UEnemyAISubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+	CombatGrid = Collection.InitializeDependency<UCombatGridSubsystem>();
+}
+
+void UEnemyAISubsystem::Tick(float DeltaTime) {
+	SLASH_BENCHMARK_SCOPE(ESBC_AI);
+	Super::Tick(DeltaTime);
+
+	if (Enemies.Num() == 0) { return; }
+	SLASH_SCOPE_HOT_PATH(EnemyAI);
+	++FrameCounter;
+	GatherInputs();
+	EvaluateDecisions();
+	ApplyDecisions();
+}
+
+TStatId UEnemyAISubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyAISubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyAISubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemyAISubsystem::RegisterEnemy(AEnemy* Enemy) {
+	if (Enemy == nullptr || EnemyIndices.Contains(Enemy)) { return; }
+
+	EnemyIndices.Add(Enemy, Enemies.Add(Enemy));
+	// Consecutive offsets spread each LOD's updates evenly over its interval
+	StaggerOffsets.Add(NextStaggerOffset++);
+}
+
+void UEnemyAISubsystem::UnregisterEnemy(AEnemy* Enemy) {
+	int32 Index = INDEX_NONE;
+	if (!EnemyIndices.RemoveAndCopyValue(Enemy, Index)) { return; }
+
+	// Swapping now would move an enemy the loop hasn't reached into a slot it's already past
+	if (bApplyingDecisions) {
+		Enemies[Index] = nullptr;
+		bHasDeferredRemovals = true;
+		return;
+	}
+	RemoveEnemyAt(Index);
+}
+
+void UEnemyAISubsystem::RemoveEnemyAt(int32 Index) {
+	// The last enemy is about to be swapped into Index, so fix up its index
+	const int32 LastIndex = Enemies.Num() - 1;
+	if (Index != LastIndex && Enemies[LastIndex]) {
+		EnemyIndices.Add(Enemies[LastIndex], Index);
+	}
+	Enemies.RemoveAtSwap(Index);
+	StaggerOffsets.RemoveAtSwap(Index);
+}
+
+/*
+* Batched pass
+*/
+void UEnemyAISubsystem::GatherInputs() {
+	const int32 NumEnemies = Enemies.Num();
+	Inputs.SetNum(NumEnemies);
+	Decisions.SetNumUninitialized(NumEnemies);
+	// Every slot starts empty, an enemy that didn't look this frame mustn't act on last frame's sighting
+	SeenTargets.Reset();
+	SeenTargets.SetNumZeroed(NumEnemies);
+	UpdateThisFrame.SetNumUninitialized(NumEnemies);
+	CombatRanges.SetNum(NumEnemies);
+
+	GatherPlayerLocations();
+	FMemory::Memzero(NumEnemiesPerLOD);
+	int32 NumEnemiesPerState[(uint8)EEnemyState::EES_Engaged + 1] = {};
+
+	for (int32 Index = 0; Index < NumEnemies; ++Index) {
+		AEnemy* Enemy = Enemies[Index];
+		if (!IsValid(Enemy)) {
+			UpdateThisFrame[Index] = false;
+			CombatRanges.SetEntryNoTarget(Index);
+			continue;
+		}
+
+		++NumEnemiesPerState[(uint8)Enemy->GetEnemyState()];
+		const EEnemyAILOD LOD = ComputeLOD(Enemy);
+		++NumEnemiesPerLOD[(uint8)LOD];
+		// Promotion always wins so reactions to damage or sight are never delayed
+		const bool bPromoted = Enemy->ConsumeAIPromotion();
+		UpdateThisFrame[Index] = bPromoted || ShouldUpdateThisFrame(LOD, StaggerOffsets[Index]);
+		if (!UpdateThisFrame[Index]) {
+			CombatRanges.SetEntryNoTarget(Index);
+			continue;
+		}
+
+		FEnemyAIInput& Input = Inputs[Index];
+		Enemy->GatherAIInput(Input);
+		if (Input.bHasCombatTarget) {
+			CombatRanges.SetEntry(Index, Input.Location, Input.CombatTargetLocation, Input.AttackRadius, Input.CombatRadius);
+		} else {
+			CombatRanges.SetEntryNoTarget(Index);
+		}
+	}
+
+	SLASH_SET_COUNT(EnemiesNearLOD, NumEnemiesPerLOD[(uint8)EEnemyAILOD::EAL_Near]);
+	SLASH_SET_COUNT(EnemiesMidLOD, NumEnemiesPerLOD[(uint8)EEnemyAILOD::EAL_Mid]);
+	SLASH_SET_COUNT(EnemiesFarLOD, NumEnemiesPerLOD[(uint8)EEnemyAILOD::EAL_Far]);
+	SLASH_SET_COUNT(EnemiesIdle, NumEnemiesPerState[(uint8)EEnemyState::EES_NoState]);
+	SLASH_SET_COUNT(EnemiesPatrolling, NumEnemiesPerState[(uint8)EEnemyState::EES_Patrolling]);
+	SLASH_SET_COUNT(EnemiesChasing, NumEnemiesPerState[(uint8)EEnemyState::EES_Chasing]);
+	SLASH_SET_COUNT(EnemiesAttacking, NumEnemiesPerState[(uint8)EEnemyState::EES_Attacking]);
+	SLASH_SET_COUNT(EnemiesEngaged, NumEnemiesPerState[(uint8)EEnemyState::EES_Engaged]);
+	SLASH_SET_COUNT(EnemiesDead, NumEnemiesPerState[(uint8)EEnemyState::EES_Dead]);
+}
+
+void UEnemyAISubsystem::EvaluateDecisions() {
+	// One tight pass over contiguous positions, cheap enough that it isn't worth splitting up
+	CombatRanges.Classify();
+
+	const int32 NumEnemies = Inputs.Num();
+	// Every index only reads its own input and writes its own decision, so no locking needed
+	ParallelFor(NumEnemies, [this](int32 Index) {
+		if (!UpdateThisFrame[Index]) {
+			Decisions[Index] = EEnemyAIDecision::EAD_None;
+			return;
+		}
+		const FEnemyAIInput& Input = Inputs[Index];
+		Decisions[Index] = FCombatRules::DecideAction(Input, CombatRanges.GetBand(Index));
+		// The grid only changes in its own tick, so reading it from here is safe
+		if (Input.bWantsSight && CombatGrid) {
+			SeenTargets[Index] = CombatGrid->FindNearestTargetInView(Input.Location, Input.Forward, Input.SightRadius, Input.PeripheralVisionCosine);
+		}
+	}, NumEnemies < MinEnemiesForParallel ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void UEnemyAISubsystem::ApplyDecisions() {
+	// Deciding can kill, pool or spawn enemies. Removals are deferred so the arrays keep their order, anyone
+	// registered mid loop is past the end of this frame's decisions and waits for the next pass
+	bApplyingDecisions = true;
+	const int32 NumDecisions = Decisions.Num();
+	for (int32 Index = 0; Index < NumDecisions; ++Index) {
+		AEnemy* Enemy = Enemies[Index];
+		if (!IsValid(Enemy)) { continue; }
+		if (Decisions[Index] != EEnemyAIDecision::EAD_None) {
+			Enemy->ExecuteAIDecision(Decisions[Index]);
+		}
+		// After the decision, so a sighting can cancel the patrol timer it may have just set
+		if (SeenTargets[Index] && Enemies[Index] == Enemy) {
+			Enemy->SenseTarget(SeenTargets[Index]);
+		}
+	}
+	bApplyingDecisions = false;
+
+	if (bHasDeferredRemovals) {
+		bHasDeferredRemovals = false;
+		// Backwards so each swap only brings in an enemy that's already been checked
+		for (int32 Index = Enemies.Num() - 1; Index >= 0; --Index) {
+			if (Enemies[Index] == nullptr) {
+				RemoveEnemyAt(Index);
+			}
+		}
+	}
+}
+
+/*
+* AI LOD
+*/
+void UEnemyAISubsystem::GatherPlayerLocations() {
+	PlayerLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It) {
+		const APlayerController* PlayerController = It->Get();
+		if (PlayerController && PlayerController->GetPawn()) {
+			PlayerLocations.Add(PlayerController->GetPawn()->GetActorLocation());
+		}
+	}
+}
+
+EEnemyAILOD UEnemyAISubsystem::ComputeLOD(const AEnemy* Enemy) const {
+	// Anything already fighting stays at full rate no matter where the players are
+	const EEnemyState EnemyState = Enemy->GetEnemyState();
+	if (EnemyState > EEnemyState::EES_Patrolling) { return EEnemyAILOD::EAL_Near; }
+
+	const FVector Location = Enemy->GetActorLocation();
+	double NearestDistSquared = TNumericLimits<double>::Max();
+	for (const FVector& PlayerLocation : PlayerLocations) {
+		NearestDistSquared = FMath::Min(NearestDistSquared, FVector::DistSquared(Location, PlayerLocation));
+	}
+
+	if (NearestDistSquared > FMath::Square((double)CVarEnemyAIFarDistance.GetValueOnGameThread())) {
+		return EEnemyAILOD::EAL_Far;
+	} else if (NearestDistSquared > FMath::Square((double)CVarEnemyAIMidDistance.GetValueOnGameThread())) {
+		return EEnemyAILOD::EAL_Mid;
+	}
+	return EEnemyAILOD::EAL_Near;
+}
+
+bool UEnemyAISubsystem::ShouldUpdateThisFrame(EEnemyAILOD LOD, uint32 StaggerOffset) const {
+	int32 Interval = 1;
+	if (LOD == EEnemyAILOD::EAL_Mid) {
+		Interval = CVarEnemyAIMidInterval.GetValueOnGameThread();
+	} else if (LOD == EEnemyAILOD::EAL_Far) {
+		Interval = CVarEnemyAIFarInterval.GetValueOnGameThread();
+	}
+	if (Interval <= 1) { return true; }
+	return (FrameCounter + StaggerOffset) % (uint32)Interval == 0;
+}
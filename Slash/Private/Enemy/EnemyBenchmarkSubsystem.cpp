@@ -0,0 +1,315 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/EnemyBenchmarkSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "Enemy/PatrolRoute.h"
+#include "Enemy/EnemyPoolSubsystem.h"
+#include "Combat/StatusEffectSubsystem.h"
+#include "Combat/CombatGridSubsystem.h"
+#include "Components/AttributeComponent.h"
+#include "Components/FactionComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Slash/SlashStats.h"
+
+namespace EnemyBenchmark {
+	static constexpr double FrameRate = 30.0;
+	static constexpr double WarmupSeconds = 2.0;
+	// Far enough apart that enemies start out patrolling rather than piled on each other
+	static constexpr double EnemySpacing = 400.0;
+	static constexpr double RouteHalfSize = 150.0;
+	static constexpr double TargetSpeed = 400.0;
+	// Keeps the target standing through the run so the enemies have someone to fight
+	static constexpr float TargetRegenPerSecond = 500.f;
+}
+
+void UEnemyBenchmarkSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	if (!IsRunning()) { return; }
+	if (!Target.IsValid()) {
+		UE_LOG(LogTemp, Warning, TEXT("Enemy scaling benchmark: target pawn went away, stopping early"));
+		FinishBenchmark();
+		return;
+	}
+
+	MoveTarget();
+	++FrameNumber;
+
+	if (WarmupFramesLeft > 0) {
+		// Spawning and the first round of path queries stay out of the numbers
+		if (--WarmupFramesLeft == 0) {
+			FSlashBenchmarkTimers::Reset();
+			FSlashBenchmarkTimers::bRecording = true;
+			LastFrameTime = FPlatformTime::Seconds();
+		}
+		return;
+	}
+
+	RecordFrame(DeltaTime);
+	if (--RecordFramesLeft <= 0) {
+		FinishRun();
+	}
+}
+
+TStatId UEnemyBenchmarkSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyBenchmarkSubsystem::Deinitialize() {
+	if (IsRunning()) {
+		FSlashBenchmarkTimers::bRecording = false;
+		FApp::SetUseFixedTimeStep(bSavedUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+		RunIndex = INDEX_NONE;
+	}
+	Super::Deinitialize();
+}
+
+bool UEnemyBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+	return SLASH_INSTRUMENTATION && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UEnemyBenchmarkSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UEnemyBenchmarkSubsystem::StartBenchmark(TSubclassOf<AEnemy> InEnemyClass, const TArray<int32>& InEnemyCounts, float InSeconds, APawn* InTarget) {
+	if (IsRunning() || InEnemyClass == nullptr || InEnemyCounts.Num() == 0 || InSeconds <= 0.f) { return false; }
+	if (GetWorld()->GetSubsystem<UEnemyPoolSubsystem>() == nullptr) { return false; }
+
+	// The player pawn is the scripted target by default, it's the one the enemies already know how to find
+	Target = InTarget ? InTarget : UGameplayStatics::GetPlayerPawn(this, 0);
+	if (!Target.IsValid()) {
+		UE_LOG(LogTemp, Error, TEXT("Enemy scaling benchmark: needs a player pawn or given target to act as the target"));
+		return false;
+	}
+
+	// The player already is both of these, a given target might not be. Enemies only see and chase engageable grid targets
+	if (UFactionComponent* TargetFaction = UFactionComponent::FindFaction(Target.Get())) {
+		TargetFaction->AddFlags(EFactionFlags::EFF_Engageable);
+	}
+	if (UCombatGridSubsystem* CombatGrid = GetWorld()->GetSubsystem<UCombatGridSubsystem>()) {
+		CombatGrid->RegisterTarget(Target.Get());
+	}
+
+	EnemyClass = InEnemyClass;
+	EnemyCounts = InEnemyCounts;
+	Seconds = InSeconds;
+	Origin = Target->GetActorLocation();
+	Results.Reset();
+
+	// Same simulated time every frame no matter how slow the frame was, so runs line up between machines
+	bSavedUseFixedTimeStep = FApp::UseFixedTimeStep();
+	SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / EnemyBenchmark::FrameRate);
+
+	RunIndex = 0;
+	StartRun();
+	return true;
+}
+
+/*
+* Runs
+*/
+void UEnemyBenchmarkSubsystem::StartRun() {
+	CurrentRun = FEnemyBenchmarkRun();
+	CurrentRun.NumEnemies = EnemyCounts[RunIndex];
+	SpawnEnemies(CurrentRun.NumEnemies);
+	CurrentRun.NumSpawned = SpawnedEnemies.Num();
+
+	WarmupFramesLeft = FMath::CeilToInt32(EnemyBenchmark::WarmupSeconds * EnemyBenchmark::FrameRate);
+	RecordFramesLeft = FMath::Max(1, FMath::CeilToInt32(Seconds * EnemyBenchmark::FrameRate));
+	FrameNumber = 0;
+
+	UAttributeComponent* TargetAttributes = Target->FindComponentByClass<UAttributeComponent>();
+	UStatusEffectSubsystem* StatusEffects = GetWorld()->GetSubsystem<UStatusEffectSubsystem>();
+	if (TargetAttributes && StatusEffects) {
+		const float RunSeconds = EnemyBenchmark::WarmupSeconds + Seconds;
+		StatusEffects->ApplyEffect(TargetAttributes, EStatusEffectType::ESE_Regen, EnemyBenchmark::TargetRegenPerSecond, RunSeconds);
+	}
+}
+
+void UEnemyBenchmarkSubsystem::RecordFrame(float DeltaTime) {
+	const double Now = FPlatformTime::Seconds();
+	const double FrameMs = (Now - LastFrameTime) * 1000.0;
+	LastFrameTime = Now;
+
+	++CurrentRun.Frames;
+	CurrentRun.SimulatedSeconds += DeltaTime;
+	CurrentRun.FrameMs += FrameMs;
+	CurrentRun.MaxFrameMs = FMath::Max(CurrentRun.MaxFrameMs, FrameMs);
+	int32 NumInCombat = 0;
+	for (const AEnemy* Enemy : SpawnedEnemies) {
+		NumInCombat += IsValid(Enemy) && Enemy->GetEnemyState() > EEnemyState::EES_Patrolling;
+	}
+	CurrentRun.MaxEnemiesInCombat = FMath::Max(CurrentRun.MaxEnemiesInCombat, NumInCombat);
+	CurrentRun.AIMs += FPlatformTime::ToMilliseconds64(FSlashBenchmarkTimers::Cycles[(uint8)ESlashBenchmarkCategory::ESBC_AI]);
+	CurrentRun.MoveSchedulerMs += FPlatformTime::ToMilliseconds64(FSlashBenchmarkTimers::Cycles[(uint8)ESlashBenchmarkCategory::ESBC_MoveScheduler]);
+	CurrentRun.MovementMs += FPlatformTime::ToMilliseconds64(FSlashBenchmarkTimers::Cycles[(uint8)ESlashBenchmarkCategory::ESBC_Movement]);
+	CurrentRun.CombatMs += FPlatformTime::ToMilliseconds64(FSlashBenchmarkTimers::Cycles[(uint8)ESlashBenchmarkCategory::ESBC_Combat]);
+	FSlashBenchmarkTimers::Reset();
+}
+
+void UEnemyBenchmarkSubsystem::FinishRun() {
+	FSlashBenchmarkTimers::bRecording = false;
+	CurrentRun.bTargetSurvived = !UFactionComponent::ActorHasFlags(Target.Get(), EFactionFlags::EFF_Dead);
+
+	const double Frames = FMath::Max(1, CurrentRun.Frames);
+	UE_LOG(LogTemp, Display, TEXT("Enemy scaling benchmark: %d enemies, %d frames, %.2fms/frame (AI %.3fms, move scheduler %.3fms, movement %.3fms, combat %.3fms)"),
+		CurrentRun.NumSpawned, CurrentRun.Frames, CurrentRun.FrameMs / Frames,
+		CurrentRun.AIMs / Frames, CurrentRun.MoveSchedulerMs / Frames, CurrentRun.MovementMs / Frames, CurrentRun.CombatMs / Frames);
+	Results.Add(CurrentRun);
+
+	DestroyEnemies();
+	if (++RunIndex < EnemyCounts.Num()) {
+		StartRun();
+	} else {
+		FinishBenchmark();
+	}
+}
+
+void UEnemyBenchmarkSubsystem::FinishBenchmark() {
+	FSlashBenchmarkTimers::bRecording = false;
+	DestroyEnemies();
+	WriteResults();
+
+	if (UStatusEffectSubsystem* StatusEffects = GetWorld()->GetSubsystem<UStatusEffectSubsystem>()) {
+		if (APawn* TargetPawn = Target.Get()) {
+			StatusEffects->ClearEffects(TargetPawn->FindComponentByClass<UAttributeComponent>());
+		}
+	}
+	FApp::SetUseFixedTimeStep(bSavedUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+	RunIndex = INDEX_NONE;
+
+	// For unattended runs, e.g. -game -nullrhi -ExecCmds="slash.Benchmark.EnemyScaling" -SlashBenchmarkExit
+	if (FParse::Param(FCommandLine::Get(), TEXT("SlashBenchmarkExit"))) {
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+/*
+* Setup
+*/
+void UEnemyBenchmarkSubsystem::SpawnEnemies(int32 NumEnemies) {
+	UEnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>();
+	if (EnemyPool == nullptr) { return; }
+
+	// A square grid centred on the target, each enemy walking its own small loop
+	const int32 Side = FMath::CeilToInt32(FMath::Sqrt((double)NumEnemies));
+	const double HalfExtent = (Side - 1) * EnemyBenchmark::EnemySpacing * 0.5;
+	FieldRadius = FMath::Max(HalfExtent, EnemyBenchmark::EnemySpacing);
+
+	const TArray<FVector> RouteWaypoints = {
+		FVector(-EnemyBenchmark::RouteHalfSize, -EnemyBenchmark::RouteHalfSize, 0.0),
+		FVector(EnemyBenchmark::RouteHalfSize, -EnemyBenchmark::RouteHalfSize, 0.0),
+		FVector(EnemyBenchmark::RouteHalfSize, EnemyBenchmark::RouteHalfSize, 0.0),
+		FVector(-EnemyBenchmark::RouteHalfSize, EnemyBenchmark::RouteHalfSize, 0.0)
+	};
+	const TArray<FIntPoint> RouteLinks = { FIntPoint(0, 1), FIntPoint(1, 2), FIntPoint(2, 3), FIntPoint(3, 0) };
+
+	SpawnedEnemies.Reserve(NumEnemies);
+	SpawnedRoutes.Reserve(NumEnemies);
+	for (int32 Index = 0; Index < NumEnemies; ++Index) {
+		const FVector Location = Origin + FVector(
+			(Index % Side) * EnemyBenchmark::EnemySpacing - HalfExtent,
+			(Index / Side) * EnemyBenchmark::EnemySpacing - HalfExtent,
+			0.0);
+		const FTransform SpawnTransform(Location);
+
+		APatrolRoute* Route = GetWorld()->SpawnActor<APatrolRoute>(APatrolRoute::StaticClass(), SpawnTransform);
+		if (Route) {
+			Route->SetWaypoints(RouteWaypoints, RouteLinks);
+			SpawnedRoutes.Add(Route);
+		}
+		if (AEnemy* Enemy = EnemyPool->SpawnEnemy(EnemyClass, SpawnTransform, Route)) {
+			SpawnedEnemies.Add(Enemy);
+		}
+	}
+}
+
+void UEnemyBenchmarkSubsystem::DestroyEnemies() {
+	for (AEnemy* Enemy : SpawnedEnemies) {
+		if (IsValid(Enemy)) { Enemy->Destroy(); }
+	}
+	for (APatrolRoute* Route : SpawnedRoutes) {
+		if (IsValid(Route)) { Route->Destroy(); }
+	}
+	SpawnedEnemies.Reset();
+	SpawnedRoutes.Reset();
+}
+
+void UEnemyBenchmarkSubsystem::MoveTarget() {
+	// Half way out through the field, so enemies keep noticing it, chasing it and losing it again
+	const double Radius = FieldRadius * 0.5;
+	const double Angle = FrameNumber / EnemyBenchmark::FrameRate * EnemyBenchmark::TargetSpeed / Radius;
+	const FVector Location = Origin + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0) * Radius;
+	Target->SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+void UEnemyBenchmarkSubsystem::WriteResults() const {
+	FString Csv = TEXT("Build,Enemies,Spawned,Frames,SimulatedSeconds,AvgFrameMs,MaxFrameMs,AvgAIMs,AvgMoveSchedulerMs,AvgMovementMs,AvgCombatMs,MaxEnemiesInCombat,TargetSurvived\n");
+	for (const FEnemyBenchmarkRun& Run : Results) {
+		const double Frames = FMath::Max(1, Run.Frames);
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d,%.3f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%d\n"),
+			FApp::GetBuildVersion(), Run.NumEnemies, Run.NumSpawned, Run.Frames, Run.SimulatedSeconds,
+			Run.FrameMs / Frames, Run.MaxFrameMs, Run.AIMs / Frames, Run.MoveSchedulerMs / Frames, Run.MovementMs / Frames, Run.CombatMs / Frames,
+			Run.MaxEnemiesInCombat, Run.bTargetSurvived ? 1 : 0);
+	}
+
+	const FString FileName = FString::Printf(TEXT("EnemyScaling-%s.csv"), *FDateTime::Now().ToString());
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Slash"), FileName);
+	if (FFileHelper::SaveStringToFile(Csv, *FilePath)) {
+		UE_LOG(LogTemp, Display, TEXT("Enemy scaling benchmark: results written to %s"), *FilePath);
+	} else {
+		UE_LOG(LogTemp, Error, TEXT("Enemy scaling benchmark: couldn't write %s"), *FilePath);
+	}
+}
+
+/*
+* Console command
+*/
+#if SLASH_INSTRUMENTATION
+namespace EnemyBenchmark {
+	static void RunFromConsole(const TArray<FString>& Args, UWorld* World) {
+		UEnemyBenchmarkSubsystem* Benchmark = World ? World->GetSubsystem<UEnemyBenchmarkSubsystem>() : nullptr;
+		if (Benchmark == nullptr) { return; }
+
+		TArray<int32> EnemyCounts;
+		if (Args.Num() > 0) {
+			TArray<FString> Counts;
+			Args[0].ParseIntoArray(Counts, TEXT(","));
+			for (const FString& Count : Counts) {
+				const int32 NumEnemies = FCString::Atoi(*Count);
+				if (NumEnemies > 0) { EnemyCounts.Add(NumEnemies); }
+			}
+		} else {
+			EnemyCounts = { 100, 500, 2000 };
+		}
+		const float RunSeconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 30.f;
+
+		// Default to whatever enemy the benchmark map has placed, a bare AEnemy has no mesh or montages
+		TSubclassOf<AEnemy> BenchmarkEnemyClass = Args.Num() > 2 ? LoadClass<AEnemy>(nullptr, *Args[2]) : nullptr;
+		if (BenchmarkEnemyClass == nullptr) {
+			TActorIterator<AEnemy> It(World);
+			BenchmarkEnemyClass = It ? It->GetClass() : AEnemy::StaticClass();
+		}
+
+		if (!Benchmark->StartBenchmark(BenchmarkEnemyClass, EnemyCounts, RunSeconds)) {
+			UE_LOG(LogTemp, Warning, TEXT("Enemy scaling benchmark: couldn't start, already running or bad arguments"));
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("slash.Benchmark.EnemyScaling"),
+		TEXT("Spawns each count of patrolling enemies around the player, runs them at a fixed time step and writes per frame AI, move scheduler, movement and combat time to Saved/Profiling/Slash. Args: [Counts, e.g. 100,500,2000] [Seconds] [EnemyClass path]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunFromConsole));
+}
+#endif
@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/EnemyMoveScheduler.h"
+#include "Enemy/Enemy.h"
+#include "Slash/SlashStats.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "NavigationPath.h"
+#include "Navigation/PathFollowingComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Move Requests Queued"), STAT_SlashMoveRequestsQueued, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Move Requests Issued"), STAT_SlashMoveRequestsIssued, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Move Requests Coalesced"), STAT_SlashMoveRequestsCoalesced, STATGROUP_Slash);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Move Request Latency (ms)"), STAT_SlashMoveRequestLatency, STATGROUP_Slash);
+
+static TAutoConsoleVariable<int32> CVarEnemyMaxPathQueriesPerFrame(
+	TEXT("slash.AI.Move.MaxQueriesPerFrame"),
+	8,
+	TEXT("Most enemy path queries the move scheduler issues in a single frame"));
+
+static TAutoConsoleVariable<bool> CVarEnemyAsyncPathfinding(
+	TEXT("slash.AI.Move.Async"),
+	true,
+	TEXT("Find enemy paths asynchronously instead of inside MoveTo"));
+
+/*
+* Move requests
+*/
+bool FEnemyMoveRequest::IsSameGoal(const FEnemyMoveRequest& Other) const {
+	if (IsMoveToActor() || Other.IsMoveToActor()) {
+		return GoalActor == Other.GoalActor;
+	}
+	// Close enough that we'd stop in the same place anyway
+	return FVector::DistSquared(GoalLocation, Other.GoalLocation) <= FMath::Square(AcceptanceRadius);
+}
+
+FAIMoveRequest FEnemyMoveRequest::ToAIMoveRequest() const {
+	FAIMoveRequest MoveRequest;
+	if (AActor* Goal = GoalActor.Get()) {
+		MoveRequest.SetGoalActor(Goal);
+	} else {
+		MoveRequest.SetGoalLocation(GoalLocation);
+	}
+	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+	return MoveRequest;
+}
+
+/*
+* Scheduler
+*/
+void UEnemyMoveScheduler::Tick(float DeltaTime) {
+	SLASH_BENCHMARK_SCOPE(ESBC_MoveScheduler);
+	Super::Tick(DeltaTime);
+
+	NumIssuedThisFrame = 0;
+	if (PendingMoves.Num() > 0) {
+		// Chasers first, then whoever is closest to where they're going
+		PendingMoves.Sort([](const FEnemyMoveRequest& A, const FEnemyMoveRequest& B) {
+			if (A.Urgency != B.Urgency) { return A.Urgency > B.Urgency; }
+			return A.DistSquaredToGoal < B.DistSquaredToGoal;
+		});
+
+		const int32 MaxQueries = FMath::Max(1, CVarEnemyMaxPathQueriesPerFrame.GetValueOnGameThread());
+		int32 NumConsumed = 0;
+		while (NumConsumed < PendingMoves.Num() && NumIssuedThisFrame < MaxQueries) {
+			if (IssueMove(PendingMoves[NumConsumed])) {
+				++NumIssuedThisFrame;
+			}
+			++NumConsumed;
+		}
+		PendingMoves.RemoveAt(0, NumConsumed, EAllowShrinking::No);
+		// Sorting moved everyone
+		RebuildPendingIndices();
+	}
+
+	SLASH_SET_COUNT(MoveRequestsQueued, GetQueueDepth());
+	SLASH_SET_COUNT(MoveRequestsIssued, NumIssuedThisFrame);
+	SLASH_SET_COUNT(MoveRequestsCoalesced, NumCoalescedThisFrame);
+	SLASH_SET_MS(MoveRequestLatency, AverageLatency * 1000.0);
+	NumCoalescedThisFrame = 0;
+}
+
+TStatId UEnemyMoveScheduler::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyMoveScheduler, STATGROUP_Tickables);
+}
+
+bool UEnemyMoveScheduler::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemyMoveScheduler::RequestMove(AEnemy* Enemy, AActor* GoalActor, const FVector& GoalLocation, float AcceptanceRadius, EEnemyMoveUrgency Urgency) {
+	if (Enemy == nullptr) { return; }
+
+	FEnemyMoveRequest Request;
+	Request.Enemy = Enemy;
+	Request.GoalActor = GoalActor;
+	Request.GoalLocation = GoalActor ? GoalActor->GetActorLocation() : GoalLocation;
+	Request.AcceptanceRadius = AcceptanceRadius;
+	Request.Urgency = Urgency;
+	Request.DistSquaredToGoal = FVector::DistSquared(Enemy->GetActorLocation(), Request.GoalLocation);
+	Request.RequestTime = GetWorld()->GetTimeSeconds();
+
+	if (IsAlreadyMovingTo(Enemy, Request)) {
+		++NumCoalescedThisFrame;
+		return;
+	}
+
+	// A path for the same goal is already being found, otherwise the new goal makes it stale
+	if (const uint32* QueryID = InFlightQueryIDs.Find(Enemy)) {
+		const FEnemyMoveRequest* InFlight = InFlightMoves.Find(*QueryID);
+		if (InFlight && InFlight->IsSameGoal(Request)) {
+			++NumCoalescedThisFrame;
+			return;
+		}
+		InFlightMoves.Remove(*QueryID);
+		InFlightQueryIDs.Remove(Enemy);
+	}
+
+	// Only the latest goal per enemy matters, but keep its place in line
+	if (const int32* PendingIndex = PendingIndices.Find(Enemy)) {
+		FEnemyMoveRequest& Pending = PendingMoves[*PendingIndex];
+		if (Pending.IsSameGoal(Request) && Pending.Urgency >= Request.Urgency) {
+			++NumCoalescedThisFrame;
+			return;
+		}
+		Request.RequestTime = Pending.RequestTime;
+		Pending = Request;
+		return;
+	}
+	PendingIndices.Add(Enemy, PendingMoves.Add(Request));
+}
+
+void UEnemyMoveScheduler::CancelMoves(AEnemy* Enemy) {
+	if (const int32* PendingIndex = PendingIndices.Find(Enemy)) {
+		RemovePendingMove(*PendingIndex);
+	}
+	uint32 QueryID = INVALID_NAVQUERYID;
+	if (InFlightQueryIDs.RemoveAndCopyValue(Enemy, QueryID)) {
+		InFlightMoves.Remove(QueryID);
+	}
+	IssuedMoves.Remove(Enemy);
+}
+
+void UEnemyMoveScheduler::RemovePendingMove(int32 Index) {
+	const int32 LastIndex = PendingMoves.Num() - 1;
+	PendingIndices.Remove(PendingMoves[Index].Enemy.Get());
+	if (Index != LastIndex) {
+		// Last request is about to be swapped into the removed slot
+		if (AEnemy* Moved = PendingMoves[LastIndex].Enemy.Get()) {
+			PendingIndices.Add(Moved, Index);
+		}
+	}
+	PendingMoves.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+void UEnemyMoveScheduler::RebuildPendingIndices() {
+	PendingIndices.Reset();
+	for (int32 Index = 0; Index < PendingMoves.Num(); ++Index) {
+		// Destroyed enemies are dropped by IssueMove, nothing to look them up by
+		if (AEnemy* Enemy = PendingMoves[Index].Enemy.Get()) {
+			PendingIndices.Add(Enemy, Index);
+		}
+	}
+}
+
+bool UEnemyMoveScheduler::IssueMove(const FEnemyMoveRequest& Request) {
+	AEnemy* Enemy = Request.Enemy.Get();
+	AAIController* Controller = Enemy ? Enemy->GetEnemyController() : nullptr;
+	if (Controller == nullptr || Enemy->GetEnemyState() == EEnemyState::EES_Dead) { return false; }
+	// Goal actor died while we were waiting
+	if (Request.IsMoveToActor() && !Request.GoalActor.IsValid()) { return false; }
+
+	const FAIMoveRequest MoveRequest = Request.ToAIMoveRequest();
+
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	FPathFindingQuery Query;
+	if (CVarEnemyAsyncPathfinding.GetValueOnGameThread() && NavSystem && Controller->BuildPathfindingQuery(MoveRequest, Query)) {
+		const uint32 QueryID = NavSystem->FindPathAsync(
+			Enemy->GetNavAgentPropertiesRef(),
+			Query,
+			FNavPathQueryDelegate::CreateUObject(this, &UEnemyMoveScheduler::OnPathFound)
+		);
+		if (QueryID != INVALID_NAVQUERYID) {
+			InFlightMoves.Add(QueryID, Request);
+			InFlightQueryIDs.Add(Enemy, QueryID);
+			return true;
+		}
+	}
+
+	// MoveTo finds the path itself, so the enemy is moving as of now
+	RecordLatency(GetWorld()->GetTimeSeconds() - Request.RequestTime);
+	Controller->MoveTo(MoveRequest);
+	IssuedMoves.Add(Enemy, Request);
+	return true;
+}
+
+void UEnemyMoveScheduler::OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path) {
+	FEnemyMoveRequest Request;
+	// Missing means a newer request for the same enemy replaced this one
+	if (!InFlightMoves.RemoveAndCopyValue(QueryID, Request)) { return; }
+
+	AEnemy* Enemy = Request.Enemy.Get();
+	InFlightQueryIDs.Remove(Enemy);
+	AAIController* Controller = Enemy ? Enemy->GetEnemyController() : nullptr;
+	if (Controller == nullptr || Enemy->GetEnemyState() == EEnemyState::EES_Dead) { return; }
+	if (Result != ENavigationQueryResult::Success || !Path.IsValid()) { return; }
+
+	// Same setup AAIController::MoveTo does for the paths it finds itself
+	if (Request.IsMoveToActor()) {
+		AActor* GoalActor = Request.GoalActor.Get();
+		if (GoalActor == nullptr) { return; }
+		Path->SetGoalActorObservation(*GoalActor, 100.f);
+	}
+	Path->EnableRecalculationOnInvalidation(true);
+
+	// Counted from the original request to the path coming back, queueing and pathfinding both
+	RecordLatency(GetWorld()->GetTimeSeconds() - Request.RequestTime);
+	Controller->RequestMove(Request.ToAIMoveRequest(), Path);
+	IssuedMoves.Add(Enemy, Request);
+}
+
+bool UEnemyMoveScheduler::IsAlreadyMovingTo(AEnemy* Enemy, const FEnemyMoveRequest& Request) const {
+	const FEnemyMoveRequest* Issued = IssuedMoves.Find(Enemy);
+	if (Issued == nullptr || !Issued->IsSameGoal(Request)) { return false; }
+	const AAIController* Controller = Enemy->GetEnemyController();
+	return Controller && Controller->GetMoveStatus() == EPathFollowingStatus::Moving;
+}
+
+void UEnemyMoveScheduler::RecordLatency(double Latency) {
+	// Exponential moving average, recent frames matter more than the whole session
+	AverageLatency = FMath::Lerp(AverageLatency, Latency, 0.1);
+}
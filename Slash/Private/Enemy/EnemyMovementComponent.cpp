@@ -0,0 +1,10 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/EnemyMovementComponent.h"
+#include "Slash/SlashStats.h"
+
+void UEnemyMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+	SLASH_BENCHMARK_SCOPE(ESBC_Movement);
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+}
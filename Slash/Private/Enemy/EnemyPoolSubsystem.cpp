@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/EnemyPoolSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "Slash/SlashStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Spawn"), STAT_SlashEnemySpawn, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Corpses"), STAT_SlashEnemyCorpses, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Reused From Pool"), STAT_SlashEnemiesReused, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Spawned New"), STAT_SlashEnemiesSpawned, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarEnemyPooling(
+	TEXT("slash.Pool.Enemies"),
+	true,
+	TEXT("Recycle dead enemies and their weapons instead of destroying them. Turn off to compare spawn and GC cost"));
+
+static TAutoConsoleVariable<int32> CVarEnemyMaxCorpses(
+	TEXT("slash.Pool.MaxCorpses"),
+	16,
+	TEXT("Most enemy corpses left visible at once, the oldest is pooled early past this"));
+
+static TAutoConsoleVariable<int32> CVarEnemyMaxPooledPerClass(
+	TEXT("slash.Pool.MaxEnemiesPerClass"),
+	64,
+	TEXT("Most hidden enemies kept around per enemy class, extras are destroyed"));
+
+void UEnemyPoolSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const int32 MaxCorpses = FMath::Max(0, CVarEnemyMaxCorpses.GetValueOnGameThread());
+	// Corpses are in death order, so both the expired and the over-cap ones are at the front
+	while (Corpses.Num() > 0 && (Corpses[0].ExpireTime <= Now || Corpses.Num() > MaxCorpses)) {
+		ReleaseCorpse(0);
+	}
+
+	SLASH_SET_COUNT(EnemyCorpses, Corpses.Num());
+}
+
+TStatId UEnemyPoolSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPoolSubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UEnemyPoolSubsystem::IsPoolingEnabled() const {
+	return CVarEnemyPooling.GetValueOnGameThread();
+}
+
+AEnemy* UEnemyPoolSubsystem::SpawnEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& SpawnTransform, APatrolRoute* PatrolRoute) {
+	SLASH_SCOPE_HOT_PATH(EnemySpawn);
+	UWorld* World = GetWorld();
+	if (World == nullptr || EnemyClass == nullptr) { return nullptr; }
+
+	if (FEnemyPoolBucket* Bucket = PooledEnemies.Find(EnemyClass)) {
+		while (Bucket->Enemies.Num() > 0) {
+			AEnemy* Enemy = Bucket->Enemies.Pop(false);
+			if (IsValid(Enemy)) {
+				Enemy->ReactivateFromPool(SpawnTransform, PatrolRoute);
+				++NumReused;
+				SLASH_COUNT(EnemiesReused, 1);
+				return Enemy;
+			}
+		}
+	}
+
+	// Deferred so the patrol route is set before BeginPlay starts the enemy moving
+	AEnemy* Enemy = World->SpawnActorDeferred<AEnemy>(EnemyClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (Enemy) {
+		Enemy->SetPatrolRoute(PatrolRoute);
+		Enemy->FinishSpawning(SpawnTransform);
+		++NumSpawned;
+		SLASH_COUNT(EnemiesSpawned, 1);
+	}
+	return Enemy;
+}
+
+void UEnemyPoolSubsystem::AddCorpse(AEnemy* Enemy, float LifeSpan) {
+	if (Enemy == nullptr) { return; }
+	FEnemyCorpse& Corpse = Corpses.AddDefaulted_GetRef();
+	Corpse.Enemy = Enemy;
+	Corpse.ExpireTime = GetWorld()->GetTimeSeconds() + LifeSpan;
+}
+
+void UEnemyPoolSubsystem::ReleaseCorpse(int32 CorpseIndex) {
+	AEnemy* Enemy = Corpses[CorpseIndex].Enemy;
+	Corpses.RemoveAt(CorpseIndex, 1, false);
+	if (!IsValid(Enemy)) { return; }
+
+	FEnemyPoolBucket& Bucket = PooledEnemies.FindOrAdd(Enemy->GetClass());
+	if (Bucket.Enemies.Num() >= CVarEnemyMaxPooledPerClass.GetValueOnGameThread()) {
+		Enemy->Destroy();
+		return;
+	}
+	Enemy->DeactivateToPool();
+	Bucket.Enemies.Add(Enemy);
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/PatrolRoute.h"
+
+APatrolRoute::APatrolRoute()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
+}
+
+void APatrolRoute::OnConstruction(const FTransform& Transform) {
+	Super::OnConstruction(Transform);
+	BuildAdjacency();
+}
+
+void APatrolRoute::PostInitializeComponents() {
+	Super::PostInitializeComponents();
+	// Before any BeginPlay, so enemies can use the route straight away
+	BuildAdjacency();
+}
+
+int32 APatrolRoute::ChooseNextWaypoint(int32 CurrentWaypoint) const {
+	if (!Waypoints.IsValidIndex(CurrentWaypoint)) {
+		return Waypoints.Num() > 0 ? 0 : INDEX_NONE;
+	}
+	const int32 Begin = AdjacencyOffsets[CurrentWaypoint];
+	const int32 End = AdjacencyOffsets[CurrentWaypoint + 1];
+	// Dead end, stop patrolling like running out of PatrolTargets did
+	if (Begin == End) { return INDEX_NONE; }
+	return Adjacency[FMath::RandRange(Begin, End - 1)];
+}
+
+int32 APatrolRoute::FindNearestWaypoint(const FVector& Location) const {
+	const FVector LocalLocation = GetActorTransform().InverseTransformPosition(Location);
+	int32 NearestWaypoint = INDEX_NONE;
+	double NearestDistSquared = TNumericLimits<double>::Max();
+	for (int32 Index = 0; Index < Waypoints.Num(); ++Index) {
+		const double DistSquared = FVector::DistSquared(LocalLocation, Waypoints[Index]);
+		if (DistSquared < NearestDistSquared) {
+			NearestWaypoint = Index;
+			NearestDistSquared = DistSquared;
+		}
+	}
+	return NearestWaypoint;
+}
+
+FVector APatrolRoute::GetWaypointLocation(int32 Waypoint) const {
+	return GetActorTransform().TransformPosition(Waypoints[Waypoint]);
+}
+
+void APatrolRoute::SetWaypoints(const TArray<FVector>& InWaypoints, const TArray<FIntPoint>& InLinks) {
+	Waypoints = InWaypoints;
+	Links = InLinks;
+	BuildAdjacency();
+}
+
+void APatrolRoute::BuildAdjacency() {
+	const int32 NumWaypoints = Waypoints.Num();
+	AdjacencyOffsets.Reset(NumWaypoints + 1);
+	Adjacency.Reset();
+
+	// No links means a loop through the waypoints in order. Linking every pair would grow with the square of the count
+	TArray<FIntPoint> LoopLinks;
+	if (Links.Num() == 0 && NumWaypoints > 1) {
+		// Two waypoints only need the one link between them
+		const int32 NumLoopLinks = NumWaypoints == 2 ? 1 : NumWaypoints;
+		for (int32 Index = 0; Index < NumLoopLinks; ++Index) {
+			LoopLinks.Emplace(Index, (Index + 1) % NumWaypoints);
+		}
+	}
+	const TArray<FIntPoint>& RouteLinks = Links.Num() > 0 ? Links : LoopLinks;
+
+	// Count each waypoint's neighbours, prefix sum them into offsets, then fill the slots
+	AdjacencyOffsets.SetNumZeroed(NumWaypoints + 1);
+	for (const FIntPoint& Link : RouteLinks) {
+		if (Link.X == Link.Y || !Waypoints.IsValidIndex(Link.X) || !Waypoints.IsValidIndex(Link.Y)) { continue; }
+		++AdjacencyOffsets[Link.X + 1];
+		++AdjacencyOffsets[Link.Y + 1];
+	}
+	for (int32 Index = 1; Index <= NumWaypoints; ++Index) {
+		AdjacencyOffsets[Index] += AdjacencyOffsets[Index - 1];
+	}
+
+	Adjacency.SetNumUninitialized(AdjacencyOffsets[NumWaypoints]);
+	TArray<int32> NextSlot(AdjacencyOffsets.GetData(), NumWaypoints);
+	for (const FIntPoint& Link : RouteLinks) {
+		if (Link.X == Link.Y || !Waypoints.IsValidIndex(Link.X) || !Waypoints.IsValidIndex(Link.Y)) { continue; }
+		Adjacency[NextSlot[Link.X]++] = Link.Y;
+		Adjacency[NextSlot[Link.Y]++] = Link.X;
+	}
+}
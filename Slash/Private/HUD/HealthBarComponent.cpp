@@ -4,8 +4,57 @@
 #include "HUD/HealthBarComponent.h"
 #include "HUD/HealthBar.h"
 #include "Components/ProgressBar.h"
+#include "Slash/SlashStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Health Bar Refresh"), STAT_SlashHealthBarRefresh, STATGROUP_Slash);
+
+void UHealthBarComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+	SLASH_SCOPE_HOT_PATH(HealthBarRefresh);
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UAttributeComponent* BoundAttributes = Attributes.Get();
+	if (BoundAttributes == nullptr) { return; }
+	if (HealthRegenEndTime >= 0.0) {
+		bHealthDirty = true;
+		if (GetWorld()->GetTimeSeconds() >= HealthRegenEndTime) { HealthRegenEndTime = -1.0; }
+	}
+	if (bHealthDirty) {
+		bHealthDirty = false;
+		SetHealthPercent(BoundAttributes->GetHealthPercent());
+	}
+}
+
+void UHealthBarComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	BindAttributes(nullptr);
+	Super::EndPlay(EndPlayReason);
+}
+
+void UHealthBarComponent::BindAttributes(UAttributeComponent* InAttributes) {
+	if (UAttributeComponent* OldAttributes = Attributes.Get()) {
+		OldAttributes->OnAttributeChanged.Remove(AttributeChangedHandle);
+	}
+	Attributes = InAttributes;
+	if (InAttributes) {
+		AttributeChangedHandle = InAttributes->OnAttributeChanged.AddUObject(this, &UHealthBarComponent::OnAttributeChanged);
+		MarkHealthDirty();
+	}
+}
+
+void UHealthBarComponent::OnAttributeChanged(EAttributeType Attribute, float OldValue, float NewValue) {
+	if (Attribute == EAttributeType::EAT_Health) {
+		MarkHealthDirty();
+	}
+}
+
+void UHealthBarComponent::MarkHealthDirty() {
+	bHealthDirty = true;
+	if (UAttributeComponent* BoundAttributes = Attributes.Get()) {
+		HealthRegenEndTime = BoundAttributes->GetHealthLimitTime();
+	}
+}
 
 void UHealthBarComponent::SetHealthPercent(float Percent) {
+	if (FMath::IsNearlyEqual(Percent, DisplayedHealthPercent, 0.001f)) { return; }
 	// This makes it so we don't constantly have to cast every time we set the health percent
 	if (HealthBarWidget == nullptr) {
 		HealthBarWidget = Cast<UHealthBar>(GetUserWidgetObject());
@@ -13,5 +62,6 @@ void UHealthBarComponent::SetHealthPercent(float Percent) {
 	// I feel like this can be made into an else block?
 	if (HealthBarWidget && HealthBarWidget->HealthBar) {
 		HealthBarWidget->HealthBar->SetPercent(Percent);
+		DisplayedHealthPercent = Percent;
 	}
 }
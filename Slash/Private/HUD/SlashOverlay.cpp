@@ -4,27 +4,114 @@
 #include "HUD/SlashOverlay.h"
 #include "Components/ProgressBar.h"
 #include "Components/TextBlock.h"
+#include "Slash/SlashStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("HUD Overlay Refresh"), STAT_SlashOverlayRefresh, STATGROUP_Slash);
+
+// Bar changes smaller than this don't move a pixel
+static constexpr float BarPercentTolerance = 0.001f;
+
+void USlashOverlay::BindAttributes(UAttributeComponent* InAttributes) {
+	if (UAttributeComponent* OldAttributes = Attributes.Get()) {
+		OldAttributes->OnAttributeChanged.Remove(AttributeChangedHandle);
+	}
+	Attributes = InAttributes;
+	if (InAttributes) {
+		AttributeChangedHandle = InAttributes->OnAttributeChanged.AddUObject(this, &USlashOverlay::OnAttributeChanged);
+		for (uint8 Attribute = 0; Attribute < (uint8)EAttributeType::EAT_MAX; ++Attribute) {
+			MarkDirty((EAttributeType)Attribute);
+		}
+	}
+}
+
+void USlashOverlay::NativeTick(const FGeometry& MyGeometry, float InDeltaTime) {
+	Super::NativeTick(MyGeometry, InDeltaTime);
+
+	RefreshDirtyAttributes();
+}
+
+void USlashOverlay::NativeDestruct() {
+	BindAttributes(nullptr);
+	Super::NativeDestruct();
+}
+
+void USlashOverlay::OnAttributeChanged(EAttributeType Attribute, float OldValue, float NewValue) {
+	MarkDirty(Attribute);
+}
+
+void USlashOverlay::MarkDirty(EAttributeType Attribute) {
+	DirtyAttributes |= 1 << (uint8)Attribute;
+
+	// A change can start (or stop) regen, so find out when it settles again
+	UAttributeComponent* BoundAttributes = Attributes.Get();
+	if (BoundAttributes == nullptr) { return; }
+	if (Attribute == EAttributeType::EAT_Health) {
+		HealthRegenEndTime = BoundAttributes->GetHealthLimitTime();
+	} else if (Attribute == EAttributeType::EAT_Stamina) {
+		StaminaRegenEndTime = BoundAttributes->GetStaminaLimitTime();
+	}
+}
+
+void USlashOverlay::RefreshDirtyAttributes() {
+	SLASH_SCOPE_HOT_PATH(OverlayRefresh);
+	UAttributeComponent* BoundAttributes = Attributes.Get();
+	if (BoundAttributes == nullptr) { return; }
+
+	// Regenerating bars need a refresh every frame, up to and including the one where they fill
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (HealthRegenEndTime >= 0.0) {
+		DirtyAttributes |= 1 << (uint8)EAttributeType::EAT_Health;
+		if (Now >= HealthRegenEndTime) { HealthRegenEndTime = -1.0; }
+	}
+	if (StaminaRegenEndTime >= 0.0) {
+		DirtyAttributes |= 1 << (uint8)EAttributeType::EAT_Stamina;
+		if (Now >= StaminaRegenEndTime) { StaminaRegenEndTime = -1.0; }
+	}
+	if (DirtyAttributes == 0) { return; }
+
+	if (DirtyAttributes & (1 << (uint8)EAttributeType::EAT_Health)) {
+		SetHealthBarPercent(BoundAttributes->GetHealthPercent());
+	}
+	if (DirtyAttributes & (1 << (uint8)EAttributeType::EAT_Stamina)) {
+		SetStaminaBarPercent(BoundAttributes->GetStaminaPercent());
+	}
+	if (DirtyAttributes & (1 << (uint8)EAttributeType::EAT_Gold)) {
+		SetGold(BoundAttributes->GetGold());
+	}
+	if (DirtyAttributes & (1 << (uint8)EAttributeType::EAT_Souls)) {
+		SetSouls(BoundAttributes->GetSouls());
+	}
+	DirtyAttributes = 0;
+}
 
 void USlashOverlay::SetHealthBarPercent(float Percent) {
+	if (FMath::IsNearlyEqual(Percent, DisplayedHealthPercent, BarPercentTolerance)) { return; }
 	if (HealthProgressBar) {
 		HealthProgressBar->SetPercent(Percent);
+		DisplayedHealthPercent = Percent;
 	}
 }
 
 void USlashOverlay::SetStaminaBarPercent(float Percent) {
+	if (FMath::IsNearlyEqual(Percent, DisplayedStaminaPercent, BarPercentTolerance)) { return; }
 	if (StaminaProgressBar) {
 		StaminaProgressBar->SetPercent(Percent);
+		DisplayedStaminaPercent = Percent;
 	}
 }
 
 void USlashOverlay::SetGold(int32 Gold) {
+	if (Gold == DisplayedGold) { return; }
 	if (GoldText) {
 		GoldText->SetText(FText::FromString(FString::Printf(TEXT("%d"), Gold)));
+		DisplayedGold = Gold;
 	}
 }
 
 void USlashOverlay::SetSouls(int32 Souls) {
+	if (Souls == DisplayedSouls) { return; }
 	if (SoulsText) {
 		SoulsText->SetText(FText::FromString(FString::Printf(TEXT("%d"), Souls)));
+		DisplayedSouls = Souls;
 	}
 }
@@ -3,17 +3,26 @@
 
 #include "Items/Item.h"
 #include "Slash/DebugMacros.h"
+#include "Slash/SlashStats.h"
 #include "Components/SphereComponent.h"
 #include "NiagaraComponent.h"
 #include "Interfaces/PickupInterface.h"
 #include "NiagaraFunctionLibrary.h"
 #include "Kismet/GameplayStatics.h"
+#include "Items/PickupPoolSubsystem.h"
+#include "Items/ItemHoverSubsystem.h"
+#include "Items/PickupProximitySubsystem.h"
+#include "Items/LootRegistrySubsystem.h"
+#include "Combat/CombatFXSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Item Tick"), STAT_SlashItemTick, STATGROUP_Slash);
 
 // Sets default values
 AItem::AItem()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+ 	// Hovering is batched by UItemHoverSubsystem, tick only gets turned on when there isn't one
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	ItemMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("ItemMeshComponent"));
 	ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
@@ -23,6 +32,8 @@ AItem::AItem()
 	Sphere = CreateDefaultSubobject<USphereComponent>(TEXT("Sphere"));
 	Sphere->SetupAttachment(GetRootComponent());
 	Sphere->SetSphereRadius(300.f);
+	// EnablePickup decides whether it needs to overlap anything
+	Sphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
 	ItemEffect = CreateDefaultSubobject<UNiagaraComponent>(TEXT("Embers"));
 	ItemEffect->SetupAttachment(GetRootComponent());
@@ -36,6 +47,40 @@ void AItem::BeginPlay()
 	// Binding callback to OnComponentBeginOverlap and OnComponentEndOverlap delegate
 	Sphere->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereOverlap);
 	Sphere->OnComponentEndOverlap.AddDynamic(this, &AItem::EndSphereOverlap);
+
+	if (ItemState == EItemState::EIS_Hovering) {
+		StartHovering();
+		EnablePickup();
+	}
+}
+
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	StopHovering();
+	DisablePickup();
+	Super::EndPlay(EndPlayReason);
+}
+
+void AItem::StartHovering() {
+	StopHovering();
+	RunningTime = 0.f;
+	HoverBaseLocation = GetActorLocation();
+	HoverBaseRotation = GetActorQuat();
+
+	UItemHoverSubsystem* HoverSubsystem = GetWorld()->GetSubsystem<UItemHoverSubsystem>();
+	if (HoverSubsystem && HoverSubsystem->IsBatchingEnabled()) {
+		HoverSubsystem->RegisterItem(this, Amplitude, TimeConstant);
+	} else {
+		SetActorTickEnabled(true);
+	}
+}
+
+void AItem::StopHovering() {
+	if (UWorld* World = GetWorld()) {
+		if (UItemHoverSubsystem* HoverSubsystem = World->GetSubsystem<UItemHoverSubsystem>()) {
+			HoverSubsystem->UnregisterItem(this);
+		}
+	}
+	SetActorTickEnabled(false);
 }
 
 float AItem::TransformedSin(){
@@ -46,7 +91,48 @@ float AItem::TransformedCos(){
 	return Amplitude * FMath::Cos(RunningTime * TimeConstant);
 }
 
+void AItem::EnablePickup() {
+	UPickupProximitySubsystem* PickupProximity = GetWorld()->GetSubsystem<UPickupProximitySubsystem>();
+	const bool bUseProximity = PickupProximity && PickupProximity->IsProximityEnabled();
+	if (bUseProximity) {
+		PickupProximity->RegisterItem(this, Sphere ? Sphere->GetScaledSphereRadius() : 0.f);
+	}
+	// The sphere only generates overlaps when there's no proximity grid, either way it still shows the range in the editor
+	if (Sphere) {
+		Sphere->SetGenerateOverlapEvents(!bUseProximity);
+		// Re-arming the sphere fires a fresh overlap if someone is already standing on the spot
+		Sphere->SetCollisionEnabled(bUseProximity ? ECollisionEnabled::NoCollision : ECollisionEnabled::QueryOnly);
+	}
+}
+
+void AItem::DisablePickup() {
+	if (UWorld* World = GetWorld()) {
+		if (UPickupProximitySubsystem* PickupProximity = World->GetSubsystem<UPickupProximitySubsystem>()) {
+			PickupProximity->UnregisterItem(this);
+		}
+		// Off the ground, so it's nothing the loot registry should turn back into an entry
+		if (ULootRegistrySubsystem* LootRegistry = World->GetSubsystem<ULootRegistrySubsystem>()) {
+			LootRegistry->ForgetLoot(this);
+		}
+	}
+	if (Sphere) {
+		Sphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+}
+
+bool AItem::TryAutoPickup(AActor* Interactor) {
+	return false;
+}
+
+int32 AItem::GetLootValue() const {
+	return 0;
+}
+
+void AItem::SetLootValue(int32 Value) {
+}
+
 void AItem::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) {
+	if (TryAutoPickup(OtherActor)) { return; }
 	IPickupInterface* PickupInterface = Cast<IPickupInterface>(OtherActor);
 	if (PickupInterface) {
 		PickupInterface->SetOverlappingItem(this);
@@ -61,29 +147,64 @@ void AItem::EndSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* O
 }
 
 void AItem::SpawnPickupEffect() {
-	if (PickupEffect) {
+	if (PickupEffect == nullptr) { return; }
+	if (UCombatFXSubsystem* CombatFX = GetWorld()->GetSubsystem<UCombatFXSubsystem>()) {
+		CombatFX->QueueNiagara(PickupEffect, GetActorLocation());
+	} else {
 		UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, PickupEffect, GetActorLocation());
 	}
 }
 
 void AItem::SpawnPickupSound() {
-	if (PickupSound) {
+	if (PickupSound == nullptr) { return; }
+	if (UCombatFXSubsystem* CombatFX = GetWorld()->GetSubsystem<UCombatFXSubsystem>()) {
+		CombatFX->QueueSound(PickupSound, GetActorLocation());
+	} else {
 		UGameplayStatics::SpawnSoundAtLocation(this, PickupSound, GetActorLocation());
 	}
 }
 
+void AItem::ConsumePickup() {
+	if (UPickupPoolSubsystem* PickupPool = GetWorld()->GetSubsystem<UPickupPoolSubsystem>()) {
+		PickupPool->ReleasePickup(this);
+	} else {
+		Destroy();
+	}
+}
+
+void AItem::ActivatePickup(const FVector& Location, const FRotator& Rotation) {
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	ItemState = EItemState::EIS_Hovering;
+	SetActorHiddenInGame(false);
+	StartHovering();
+	EnablePickup();
+	if (ItemEffect) {
+		ItemEffect->Activate(true);
+	}
+}
+
+void AItem::DeactivatePickup() {
+	SetActorHiddenInGame(true);
+	StopHovering();
+	DisablePickup();
+	if (ItemEffect) {
+		ItemEffect->Deactivate();
+	}
+}
+
 // Called every frame
 void AItem::Tick(float DeltaTime)
 {
+	SLASH_SCOPE_HOT_PATH(ItemTick);
 	Super::Tick(DeltaTime);
 
 	RunningTime += DeltaTime;
 
-	// MovementRate * DeltaTime (cm/s) * (s/frame) = cm/frame
-	// Make item bounce up and down and rotate
+	// Unbatched fallback, same bob and spin as UItemHoverSubsystem
 	if (ItemState == EItemState::EIS_Hovering) {
-		AddActorWorldOffset(FVector(0.f, 0.f, TransformedSin()));
-		AddActorWorldRotation(FRotator(0.f, DeltaTime * 20, 0.f));
+		const FVector Location = HoverBaseLocation + FVector(0.f, 0.f, UItemHoverSubsystem::GetHoverHeight(Amplitude, TimeConstant, RunningTime));
+		const FQuat Rotation = FQuat(FVector::UpVector, FMath::DegreesToRadians(UItemHoverSubsystem::GetHoverYaw(RunningTime))) * HoverBaseRotation;
+		GetRootComponent()->SetWorldLocationAndRotationNoPhysics(Location, Rotation.Rotator());
 	}
 	
 }
\ No newline at end of file
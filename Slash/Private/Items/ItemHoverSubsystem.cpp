@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/ItemHoverSubsystem.h"
+#include "Items/Item.h"
+#include "Slash/SlashStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Item Hover"), STAT_SlashItemHover, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Items Hovering"), STAT_SlashItemsHovering, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarBatchedItemHover(
+	TEXT("slash.Items.BatchedHover"),
+	true,
+	TEXT("Animate hovering pickups in one batched pass. Turn off to have every item tick its own hover again"));
+
+// The old hover added its offset once per frame, tuned at this rate
+static constexpr float HoverReferenceFrameRate = 60.f;
+static constexpr float HoverSpinDegreesPerSecond = 20.f;
+
+void UItemHoverSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	SLASH_SET_COUNT(ItemsHovering, Items.Num());
+	if (Items.Num() == 0) { return; }
+	SLASH_SCOPE_HOT_PATH(ItemHover);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (int32 Index = 0; Index < Items.Num(); ++Index) {
+		USceneComponent* Root = IsValid(Items[Index]) ? Items[Index]->GetRootComponent() : nullptr;
+		if (Root == nullptr) { continue; }
+
+		const float HoverTime = (float)(Now - StartTimes[Index]);
+		const FVector Location = BaseLocations[Index] + FVector(0.f, 0.f, GetHoverHeight(Amplitudes[Index], TimeConstants[Index], HoverTime));
+		const FQuat Rotation = FQuat(FVector::UpVector, FMath::DegreesToRadians(GetHoverYaw(HoverTime))) * BaseRotations[Index];
+		Root->SetWorldLocationAndRotationNoPhysics(Location, Rotation.Rotator());
+	}
+}
+
+TStatId UItemHoverSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemHoverSubsystem, STATGROUP_Tickables);
+}
+
+bool UItemHoverSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UItemHoverSubsystem::IsBatchingEnabled() const {
+	return CVarBatchedItemHover.GetValueOnGameThread();
+}
+
+void UItemHoverSubsystem::RegisterItem(AItem* Item, float Amplitude, float TimeConstant) {
+	if (Item == nullptr || ItemIndices.Contains(Item)) { return; }
+
+	ItemIndices.Add(Item, Items.Add(Item));
+	BaseLocations.Add(Item->GetActorLocation());
+	BaseRotations.Add(Item->GetActorQuat());
+	Amplitudes.Add(Amplitude);
+	TimeConstants.Add(TimeConstant);
+	StartTimes.Add(GetWorld()->GetTimeSeconds());
+}
+
+void UItemHoverSubsystem::UnregisterItem(AItem* Item) {
+	int32 Index = INDEX_NONE;
+	if (!ItemIndices.RemoveAndCopyValue(Item, Index)) { return; }
+
+	// The last item is about to be swapped into Index
+	const int32 LastIndex = Items.Num() - 1;
+	if (Index != LastIndex) {
+		ItemIndices.Add(Items[LastIndex], Index);
+	}
+	Items.RemoveAtSwap(Index);
+	BaseLocations.RemoveAtSwap(Index);
+	BaseRotations.RemoveAtSwap(Index);
+	Amplitudes.RemoveAtSwap(Index);
+	TimeConstants.RemoveAtSwap(Index);
+	StartTimes.RemoveAtSwap(Index);
+}
+
+float UItemHoverSubsystem::GetHoverHeight(float Amplitude, float TimeConstant, float HoverTime) {
+	// Adding Amplitude * sin(TimeConstant * t) every frame sums to this
+	if (TimeConstant == 0.f) { return 0.f; }
+	return Amplitude * HoverReferenceFrameRate / TimeConstant * (1.f - FMath::Cos(TimeConstant * HoverTime));
+}
+
+float UItemHoverSubsystem::GetHoverYaw(float HoverTime) {
+	return FMath::Fmod(HoverSpinDegreesPerSecond * HoverTime, 360.f);
+}
@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/LootBenchmarkSubsystem.h"
+#include "Items/Item.h"
+#include "Items/Soul.h"
+#include "Items/Treasure.h"
+#include "Items/LootRegistrySubsystem.h"
+#include "Items/PickupPoolSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "Slash/SlashStats.h"
+
+namespace LootBenchmark {
+	static constexpr int32 WarmupFrames = 30;
+	static constexpr int32 RecordedFrames = 300;
+	// Drops land between these multiples of the materialize distance, so none of them start out as pickups
+	static constexpr double MinRingScale = 1.5;
+	static constexpr double MaxRingScale = 4.0;
+	static constexpr int32 RandomSeed = 1337;
+
+	/* Same count `obj list` makes, the object's own size plus what its properties point at */
+	static int64 CountObjectBytes(UObject* Object) {
+		FArchiveCountMem CountMem(Object);
+		return (int64)CountMem.GetMax() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+	}
+
+	static int64 CountActorBytes(AActor* Actor) {
+		int64 Bytes = CountObjectBytes(Actor);
+		for (UActorComponent* Component : Actor->GetComponents()) {
+			if (Component) {
+				Bytes += CountObjectBytes(Component);
+			}
+		}
+		return Bytes;
+	}
+}
+
+void ULootBenchmarkSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	if (!IsRunning()) { return; }
+
+	const double NowSeconds = FPlatformTime::Seconds();
+	const double FrameMs = (NowSeconds - LastFrameSeconds) * 1000.0;
+	LastFrameSeconds = NowSeconds;
+
+	if (WarmupFramesLeft > 0) {
+		--WarmupFramesLeft;
+		return;
+	}
+
+	FLootBenchmarkRun& Run = Runs.Last();
+	++Run.Frames;
+	Run.FrameMs += FrameMs;
+	Run.MaxFrameMs = FMath::Max(Run.MaxFrameMs, FrameMs);
+	if (--FramesLeft <= 0) {
+		FinishRun();
+	}
+}
+
+TStatId ULootBenchmarkSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULootBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+bool ULootBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+	return SLASH_INSTRUMENTATION && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool ULootBenchmarkSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool ULootBenchmarkSubsystem::StartBenchmark(TSubclassOf<AItem> InLootClass, int32 InNumDrops) {
+	if (IsRunning() || InLootClass == nullptr || InNumDrops <= 0) { return false; }
+	if (GetWorld()->GetSubsystem<ULootRegistrySubsystem>() == nullptr) { return false; }
+
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (PlayerPawn == nullptr) { return false; }
+
+	LootClass = InLootClass;
+	NumDrops = InNumDrops;
+	Origin = PlayerPawn->GetActorLocation();
+	StartRun(true);
+	return true;
+}
+
+void ULootBenchmarkSubsystem::StartRun(bool bProxies) {
+	FLootBenchmarkRun& Run = Runs.AddDefaulted_GetRef();
+	Run.bProxies = bProxies;
+
+	MemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+	DropLoot(bProxies);
+
+	WarmupFramesLeft = LootBenchmark::WarmupFrames;
+	FramesLeft = LootBenchmark::RecordedFrames;
+	LastFrameSeconds = FPlatformTime::Seconds();
+}
+
+void ULootBenchmarkSubsystem::DropLoot(bool bProxies) {
+	ULootRegistrySubsystem* LootRegistry = GetWorld()->GetSubsystem<ULootRegistrySubsystem>();
+	UPickupPoolSubsystem* PickupPool = GetWorld()->GetSubsystem<UPickupPoolSubsystem>();
+	const double MaterializeDistance = LootRegistry->GetMaterializeDistance();
+
+	// Same stream both passes, so the two runs drop the exact same ring
+	FRandomStream Random(LootBenchmark::RandomSeed);
+	for (int32 DropIndex = 0; DropIndex < NumDrops; ++DropIndex) {
+		const double Radius = Random.FRandRange(MaterializeDistance * LootBenchmark::MinRingScale, MaterializeDistance * LootBenchmark::MaxRingScale);
+		const double Angle = Random.FRandRange(0.f, UE_TWO_PI);
+		const FVector Location = Origin + FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.0);
+		const FRotator Rotation(0.f, Random.FRandRange(0.f, 360.f), 0.f);
+
+		if (bProxies) {
+			LootRegistry->DropLoot(LootClass, FTransform(Rotation, Location));
+		} else {
+			AItem* Item = PickupPool ?
+				PickupPool->SpawnPickup(LootClass, Location, Rotation) :
+				GetWorld()->SpawnActor<AItem>(LootClass, Location, Rotation);
+			if (Item) {
+				SpawnedLoot.Add(Item);
+			}
+		}
+	}
+}
+
+void ULootBenchmarkSubsystem::FinishRun() {
+	FLootBenchmarkRun& Run = Runs.Last();
+	// Measured at the end of the run, so render side buffers built after the drop count too
+	Run.ProcessBytes = (int64)FPlatformMemory::GetStats().UsedPhysical - (int64)MemoryBefore;
+
+	if (Run.bProxies) {
+		Run.LootBytes = GetWorld()->GetSubsystem<ULootRegistrySubsystem>()->GetProxyAllocatedSize();
+		GetWorld()->GetSubsystem<ULootRegistrySubsystem>()->ClearProxies();
+		StartRun(false);
+		return;
+	}
+
+	for (AItem* Item : SpawnedLoot) {
+		if (IsValid(Item)) {
+			Run.LootBytes += LootBenchmark::CountActorBytes(Item);
+			Item->Destroy();
+		}
+	}
+	SpawnedLoot.Reset();
+	FinishBenchmark();
+}
+
+void ULootBenchmarkSubsystem::FinishBenchmark() {
+	UE_LOG(LogTemp, Display, TEXT("Loot benchmark: %d drops of %s"), NumDrops, *GetNameSafe(LootClass));
+	for (const FLootBenchmarkRun& Run : Runs) {
+		const int32 Frames = FMath::Max(Run.Frames, 1);
+		UE_LOG(LogTemp, Display, TEXT("  %-8s %6.2f ms/frame avg, %6.2f ms max, %8.2f MB loot, %+8.2f MB process"),
+			Run.bProxies ? TEXT("Proxies") : TEXT("Actors"),
+			Run.FrameMs / Frames,
+			Run.MaxFrameMs,
+			Run.LootBytes / (1024.0 * 1024.0),
+			Run.ProcessBytes / (1024.0 * 1024.0));
+	}
+	if (Runs.Num() == 2) {
+		UE_LOG(LogTemp, Display, TEXT("  Proxies saved %.2f ms/frame and %.2f MB of loot"),
+			Runs[1].FrameMs / FMath::Max(Runs[1].Frames, 1) - Runs[0].FrameMs / FMath::Max(Runs[0].Frames, 1),
+			(Runs[1].LootBytes - Runs[0].LootBytes) / (1024.0 * 1024.0));
+		UE_LOG(LogTemp, Display, TEXT("  Process figures are the whole process's physical memory change, allocator slack and everything else that ran included. Loot figures count the objects and instance data, not GPU memory"));
+	}
+	Runs.Reset();
+}
+
+/*
+* Console command
+*/
+#if SLASH_INSTRUMENTATION
+namespace LootBenchmark {
+	static void RunFromConsole(const TArray<FString>& Args, UWorld* World) {
+		ULootBenchmarkSubsystem* Benchmark = World ? World->GetSubsystem<ULootBenchmarkSubsystem>() : nullptr;
+		if (Benchmark == nullptr) { return; }
+
+		const int32 Drops = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 5000;
+
+		// Default to whatever soul or treasure the map has placed, a bare AItem has no mesh to instance
+		TSubclassOf<AItem> LootClass = Args.Num() > 1 ? LoadClass<AItem>(nullptr, *Args[1]) : nullptr;
+		for (TActorIterator<AItem> It(World); It && LootClass == nullptr; ++It) {
+			if (Cast<ASoul>(*It) || Cast<ATreasure>(*It)) {
+				LootClass = It->GetClass();
+			}
+		}
+		if (LootClass == nullptr) {
+			LootClass = ATreasure::StaticClass();
+		}
+
+		if (!Benchmark->StartBenchmark(LootClass, Drops)) {
+			UE_LOG(LogTemp, Warning, TEXT("Loot benchmark: couldn't start, already running, no player pawn or bad arguments"));
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("slash.Benchmark.Loot"),
+		TEXT("Drops loot in a ring around the player, once as registry proxies and once as pickup actors, and logs frame time and the memory the loot holds for each. Args: [Drops, default 5000] [ItemClass path]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunFromConsole));
+}
+#endif
@@ -0,0 +1,310 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/LootRegistrySubsystem.h"
+#include "Items/Item.h"
+#include "Items/PickupPoolSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Slash/SlashStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Loot Registry"), STAT_SlashLootRegistry, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Loot Proxies"), STAT_SlashLootProxies, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Loot Actors"), STAT_SlashLootActors, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarLootProxies(
+	TEXT("slash.Items.LootProxies"),
+	true,
+	TEXT("Keep dropped loot no player is near as instanced mesh entries instead of actors. Applies to loot dropped after the change"));
+
+static TAutoConsoleVariable<float> CVarLootMaterializeDistance(
+	TEXT("slash.Items.LootMaterializeDistance"),
+	2500.f,
+	TEXT("How close a player has to get before dropped loot becomes a real pickup"));
+
+static TAutoConsoleVariable<int32> CVarLootMaterializePerFrame(
+	TEXT("slash.Items.LootMaterializePerFrame"),
+	16,
+	TEXT("Most loot entries turned into pickups in one frame, the rest wait for the next"));
+
+// Pickups go back to entries a bit further out than they come in, so loot on the edge doesn't flip every frame
+static constexpr double LootReleaseDistanceScale = 1.25;
+
+void ULootRegistrySubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	SLASH_SET_COUNT(LootProxies, ProxyClasses.Num());
+	SLASH_SET_COUNT(LootActors, LiveLoot.Num());
+	if (ProxyClasses.Num() == 0 && LiveLoot.Num() == 0) { return; }
+	SLASH_SCOPE_HOT_PATH(LootRegistry);
+
+	UpdatePlayerLocations();
+	const double MaterializeDistance = GetMaterializeDistance();
+
+	// Highest index first, so removing a proxy only swaps in one that isn't waiting its turn
+	TArray<int32> NearProxies;
+	GatherProxiesNearPlayers(MaterializeDistance, NearProxies);
+	NearProxies.Sort(TGreater<int32>());
+	const int32 Budget = FMath::Min(NearProxies.Num(), CVarLootMaterializePerFrame.GetValueOnGameThread());
+	for (int32 NearIndex = 0; NearIndex < Budget; ++NearIndex) {
+		const int32 ProxyIndex = NearProxies[NearIndex];
+		UClass* ItemClass = ProxyClasses[ProxyIndex];
+		const FTransform Transform = ProxyTransforms[ProxyIndex];
+		const int32 Value = ProxyValues[ProxyIndex];
+		RemoveProxy(ProxyIndex);
+		TrackLoot(SpawnLoot(ItemClass, Transform, Value), Transform);
+	}
+
+	const double ReleaseDistSquared = FMath::Square(MaterializeDistance * LootReleaseDistanceScale);
+	UPickupPoolSubsystem* PickupPool = GetWorld()->GetSubsystem<UPickupPoolSubsystem>();
+	for (int32 LootIndex = LiveLoot.Num() - 1; LootIndex >= 0; --LootIndex) {
+		AItem* Item = LiveLoot[LootIndex];
+		if (IsValid(Item) && IsNearPlayer(LiveLootTransforms[LootIndex].GetLocation(), ReleaseDistSquared)) { continue; }
+
+		const FTransform Transform = LiveLootTransforms[LootIndex];
+		LiveLoot.RemoveAtSwap(LootIndex);
+		LiveLootTransforms.RemoveAtSwap(LootIndex);
+		if (!IsValid(Item)) { continue; }
+
+		AddProxy(Item->GetClass(), Transform, Item->GetLootValue());
+		if (PickupPool) {
+			PickupPool->ReleasePickup(Item);
+		} else {
+			Item->Destroy();
+		}
+	}
+}
+
+TStatId ULootRegistrySubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULootRegistrySubsystem, STATGROUP_Tickables);
+}
+
+bool ULootRegistrySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool ULootRegistrySubsystem::IsRegistryEnabled() const {
+	return CVarLootProxies.GetValueOnGameThread();
+}
+
+double ULootRegistrySubsystem::GetMaterializeDistance() const {
+	return CVarLootMaterializeDistance.GetValueOnGameThread();
+}
+
+AItem* ULootRegistrySubsystem::DropLoot(TSubclassOf<AItem> ItemClass, const FTransform& Transform, int32 Value) {
+	if (ItemClass == nullptr) { return nullptr; }
+	if (Value == INDEX_NONE) {
+		Value = ItemClass->GetDefaultObject<AItem>()->GetLootValue();
+	}
+
+	if (!IsRegistryEnabled()) {
+		return SpawnLoot(ItemClass, Transform, Value);
+	}
+
+	UpdatePlayerLocations();
+	if (!IsNearPlayer(Transform.GetLocation(), FMath::Square(GetMaterializeDistance()))) {
+		AddProxy(ItemClass, Transform, Value);
+		return nullptr;
+	}
+
+	AItem* Item = SpawnLoot(ItemClass, Transform, Value);
+	TrackLoot(Item, Transform);
+	return Item;
+}
+
+void ULootRegistrySubsystem::TrackLoot(AItem* Item, const FTransform& Transform) {
+	if (Item == nullptr) { return; }
+	LiveLoot.Add(Item);
+	LiveLootTransforms.Add(Transform);
+}
+
+void ULootRegistrySubsystem::ForgetLoot(AItem* Item) {
+	const int32 LootIndex = LiveLoot.Find(Item);
+	if (LootIndex == INDEX_NONE) { return; }
+
+	LiveLoot.RemoveAtSwap(LootIndex);
+	LiveLootTransforms.RemoveAtSwap(LootIndex);
+}
+
+void ULootRegistrySubsystem::ClearProxies() {
+	for (TPair<UClass*, FLootProxyBucket>& Pair : Buckets) {
+		if (Pair.Value.Instances) {
+			Pair.Value.Instances->ClearInstances();
+		}
+		Pair.Value.FreeInstances.Reset();
+	}
+	ProxyClasses.Reset();
+	ProxyTransforms.Reset();
+	ProxyValues.Reset();
+	ProxyInstances.Reset();
+	ProxyCells.Reset();
+	Cells.Reset();
+}
+
+SIZE_T ULootRegistrySubsystem::GetProxyAllocatedSize() const {
+	SIZE_T Bytes = ProxyClasses.GetAllocatedSize() + ProxyTransforms.GetAllocatedSize() + ProxyValues.GetAllocatedSize()
+		+ ProxyInstances.GetAllocatedSize() + ProxyCells.GetAllocatedSize() + Cells.GetAllocatedSize();
+	for (const TPair<FIntPoint, TArray<int32, TInlineAllocator<4>>>& Pair : Cells) {
+		Bytes += Pair.Value.GetAllocatedSize();
+	}
+	for (const TPair<UClass*, FLootProxyBucket>& Pair : Buckets) {
+		Bytes += Pair.Value.FreeInstances.GetAllocatedSize();
+		if (Pair.Value.Instances) {
+			Bytes += Pair.Value.Instances->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+	}
+	return Bytes;
+}
+
+void ULootRegistrySubsystem::UpdatePlayerLocations() {
+	PlayerLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It) {
+		const APlayerController* PlayerController = It->Get();
+		if (const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr) {
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+}
+
+bool ULootRegistrySubsystem::IsNearPlayer(const FVector& Location, double DistanceSquared) const {
+	for (const FVector& PlayerLocation : PlayerLocations) {
+		if (FVector::DistSquared(Location, PlayerLocation) <= DistanceSquared) { return true; }
+	}
+	return false;
+}
+
+void ULootRegistrySubsystem::GatherProxiesNearPlayers(double Distance, TArray<int32>& OutProxyIndices) const {
+	const double DistSquared = FMath::Square(Distance);
+	for (const FVector& PlayerLocation : PlayerLocations) {
+		const FIntPoint MinCell = GetCell(PlayerLocation - FVector(Distance, Distance, 0.0));
+		const FIntPoint MaxCell = GetCell(PlayerLocation + FVector(Distance, Distance, 0.0));
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X) {
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y) {
+				const TArray<int32, TInlineAllocator<4>>* CellProxies = Cells.Find(FIntPoint(X, Y));
+				if (CellProxies == nullptr) { continue; }
+				for (const int32 ProxyIndex : *CellProxies) {
+					// Players close together can both reach the same entry
+					if (FVector::DistSquared(PlayerLocation, ProxyTransforms[ProxyIndex].GetLocation()) <= DistSquared) {
+						OutProxyIndices.AddUnique(ProxyIndex);
+					}
+				}
+			}
+		}
+	}
+}
+
+void ULootRegistrySubsystem::AddProxy(UClass* ItemClass, const FTransform& Transform, int32 Value) {
+	FLootProxyBucket& Bucket = FindOrAddBucket(ItemClass);
+	int32 InstanceIndex = INDEX_NONE;
+	if (Bucket.Instances) {
+		// Either way only this instance is sent to the renderer, not the whole component
+		const FTransform InstanceTransform = Bucket.MeshTransform * Transform;
+		if (Bucket.FreeInstances.Num() > 0) {
+			InstanceIndex = Bucket.FreeInstances.Pop(false);
+			Bucket.Instances->UpdateInstanceTransform(InstanceIndex, InstanceTransform, true, true, true);
+		} else {
+			InstanceIndex = Bucket.Instances->AddInstance(InstanceTransform, true);
+		}
+	}
+
+	const FIntPoint Cell = GetCell(Transform.GetLocation());
+	const int32 ProxyIndex = ProxyClasses.Add(ItemClass);
+	ProxyTransforms.Add(Transform);
+	ProxyValues.Add(Value);
+	ProxyInstances.Add(InstanceIndex);
+	ProxyCells.Add(Cell);
+	Cells.FindOrAdd(Cell).Add(ProxyIndex);
+}
+
+void ULootRegistrySubsystem::RemoveProxy(int32 ProxyIndex) {
+	// Instance indices shift when one is removed, so the slot is hidden and kept for the next drop instead
+	const int32 InstanceIndex = ProxyInstances[ProxyIndex];
+	FLootProxyBucket* Bucket = Buckets.Find(ProxyClasses[ProxyIndex]);
+	if (Bucket && Bucket->Instances && InstanceIndex != INDEX_NONE) {
+		const FTransform Hidden(FQuat::Identity, ProxyTransforms[ProxyIndex].GetLocation(), FVector::ZeroVector);
+		Bucket->Instances->UpdateInstanceTransform(InstanceIndex, Hidden, true, true, true);
+		Bucket->FreeInstances.Add(InstanceIndex);
+	}
+
+	RemoveFromCell(ProxyCells[ProxyIndex], ProxyIndex);
+
+	// The last proxy is about to be swapped into ProxyIndex, so fix up its cell
+	const int32 LastIndex = ProxyClasses.Num() - 1;
+	if (ProxyIndex != LastIndex) {
+		if (TArray<int32, TInlineAllocator<4>>* CellProxies = Cells.Find(ProxyCells[LastIndex])) {
+			const int32 Slot = CellProxies->Find(LastIndex);
+			if (Slot != INDEX_NONE) {
+				(*CellProxies)[Slot] = ProxyIndex;
+			}
+		}
+	}
+	ProxyClasses.RemoveAtSwap(ProxyIndex);
+	ProxyTransforms.RemoveAtSwap(ProxyIndex);
+	ProxyValues.RemoveAtSwap(ProxyIndex);
+	ProxyInstances.RemoveAtSwap(ProxyIndex);
+	ProxyCells.RemoveAtSwap(ProxyIndex);
+}
+
+AItem* ULootRegistrySubsystem::SpawnLoot(UClass* ItemClass, const FTransform& Transform, int32 Value) {
+	UWorld* World = GetWorld();
+	const FVector Location = Transform.GetLocation();
+	const FRotator Rotation = Transform.Rotator();
+	UPickupPoolSubsystem* PickupPool = World->GetSubsystem<UPickupPoolSubsystem>();
+	AItem* Item = PickupPool ?
+		PickupPool->SpawnPickup(ItemClass, Location, Rotation) :
+		World->SpawnActor<AItem>(ItemClass, Location, Rotation);
+	if (Item) {
+		Item->SetLootValue(Value);
+	}
+	return Item;
+}
+
+FLootProxyBucket& ULootRegistrySubsystem::FindOrAddBucket(UClass* ItemClass) {
+	if (FLootProxyBucket* Bucket = Buckets.Find(ItemClass)) {
+		return *Bucket;
+	}
+
+	FLootProxyBucket& Bucket = Buckets.Add(ItemClass);
+	const UStaticMeshComponent* DefaultMesh = ItemClass->GetDefaultObject<AItem>()->GetItemMesh();
+	if (DefaultMesh == nullptr || DefaultMesh->GetStaticMesh() == nullptr) { return Bucket; }
+
+	if (ProxyActor == nullptr) {
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		ProxyActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		USceneComponent* Root = NewObject<USceneComponent>(ProxyActor, TEXT("Root"));
+		ProxyActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	UInstancedStaticMeshComponent* Instances = NewObject<UInstancedStaticMeshComponent>(ProxyActor);
+	Instances->SetupAttachment(ProxyActor->GetRootComponent());
+	Instances->SetStaticMesh(DefaultMesh->GetStaticMesh());
+	for (int32 MaterialIndex = 0; MaterialIndex < DefaultMesh->GetNumMaterials(); ++MaterialIndex) {
+		Instances->SetMaterial(MaterialIndex, DefaultMesh->GetMaterial(MaterialIndex));
+	}
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetCanEverAffectNavigation(false);
+	Instances->RegisterComponent();
+	ProxyActor->AddInstanceComponent(Instances);
+
+	Bucket.Instances = Instances;
+	Bucket.MeshTransform = DefaultMesh->GetRelativeTransform();
+	return Bucket;
+}
+
+FIntPoint ULootRegistrySubsystem::GetCell(const FVector& Location) const {
+	return FIntPoint(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize)
+	);
+}
+
+void ULootRegistrySubsystem::RemoveFromCell(const FIntPoint& Cell, int32 ProxyIndex) {
+	if (TArray<int32, TInlineAllocator<4>>* CellProxies = Cells.Find(Cell)) {
+		CellProxies->RemoveSingleSwap(ProxyIndex);
+		if (CellProxies->Num() == 0) {
+			Cells.Remove(Cell);
+		}
+	}
+}
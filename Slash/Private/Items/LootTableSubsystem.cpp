@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/LootTableSubsystem.h"
+#include "Items/Treasure.h"
+#include "Items/PickupPoolSubsystem.h"
+#include "Engine/AssetManager.h"
+
+static TAutoConsoleVariable<int32> CVarPrewarmPickupsPerClass(
+	TEXT("slash.Items.PrewarmPickupsPerClass"),
+	2,
+	TEXT("Hidden pickups put in the pool for each loot class once it finishes loading, so the first drop doesn't spawn one"));
+
+void ULootTableSubsystem::Deinitialize() {
+	for (const TSharedPtr<FStreamableHandle>& Handle : LoadHandles) {
+		if (Handle.IsValid()) {
+			Handle->CancelHandle();
+		}
+	}
+	LoadHandles.Reset();
+	RequestedPaths.Reset();
+	Super::Deinitialize();
+}
+
+bool ULootTableSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void ULootTableSubsystem::LoadLoot(const TArray<TSoftClassPtr<ATreasure>>& TreasureClasses, FStreamableDelegate OnLoaded) {
+	TArray<FSoftObjectPath> AllPaths;
+	TArray<FSoftObjectPath> NewPaths;
+	bool bAllResident = true;
+	for (const TSoftClassPtr<ATreasure>& TreasureClass : TreasureClasses) {
+		if (TreasureClass.IsNull()) { continue; }
+
+		const FSoftObjectPath& Path = TreasureClass.ToSoftObjectPath();
+		AllPaths.Add(Path);
+		bAllResident &= TreasureClass.Get() != nullptr;
+		if (!RequestedPaths.Contains(Path)) {
+			RequestedPaths.Add(Path);
+			NewPaths.Add(Path);
+		}
+	}
+
+	FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+	if (NewPaths.Num() > 0) {
+		LoadHandles.Add(Streamable.RequestAsyncLoad(
+			NewPaths,
+			FStreamableDelegate::CreateUObject(this, &ULootTableSubsystem::PrewarmLoot, NewPaths),
+			FStreamableManager::AsyncLoadHighPriority
+		));
+	}
+
+	if (!OnLoaded.IsBound()) { return; }
+	if (bAllResident) {
+		OnLoaded.Execute();
+		return;
+	}
+	// Joins the loads already in flight, the handle above is the one keeping the classes around afterwards
+	Streamable.RequestAsyncLoad(AllPaths, OnLoaded, FStreamableManager::AsyncLoadHighPriority);
+}
+
+TSubclassOf<ATreasure> ULootTableSubsystem::PickResidentTreasure(const TArray<TSoftClassPtr<ATreasure>>& TreasureClasses) const {
+	TArray<UClass*, TInlineAllocator<8>> Resident;
+	for (const TSoftClassPtr<ATreasure>& TreasureClass : TreasureClasses) {
+		if (UClass* Class = TreasureClass.Get()) {
+			Resident.Add(Class);
+		}
+	}
+	return Resident.Num() > 0 ? Resident[FMath::RandRange(0, Resident.Num() - 1)] : nullptr;
+}
+
+void ULootTableSubsystem::PrewarmLoot(TArray<FSoftObjectPath> LoadedPaths) {
+	UPickupPoolSubsystem* PickupPool = GetWorld() ? GetWorld()->GetSubsystem<UPickupPoolSubsystem>() : nullptr;
+	if (PickupPool == nullptr) { return; }
+
+	const int32 Count = CVarPrewarmPickupsPerClass.GetValueOnGameThread();
+	for (const FSoftObjectPath& Path : LoadedPaths) {
+		if (UClass* Class = Cast<UClass>(Path.ResolveObject())) {
+			PickupPool->PrewarmPickups(Class, Count);
+		}
+	}
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/PickupPoolSubsystem.h"
+#include "Items/Item.h"
+#include "Slash/SlashStats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickups Spawned"), STAT_SlashPickupsSpawned, STATGROUP_Slash);
+
+static TAutoConsoleVariable<int32> CVarMaxPooledPickupsPerClass(
+	TEXT("slash.Pool.MaxPickupsPerClass"),
+	128,
+	TEXT("Most hidden pickups kept around per pickup class, extras are destroyed"));
+
+bool UPickupPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+AItem* UPickupPoolSubsystem::SpawnPickup(TSubclassOf<AItem> ItemClass, const FVector& Location, const FRotator& Rotation) {
+	UWorld* World = GetWorld();
+	if (World == nullptr || ItemClass == nullptr) { return nullptr; }
+
+	if (FPickupPoolBucket* Bucket = PooledPickups.Find(ItemClass)) {
+		while (Bucket->Items.Num() > 0) {
+			AItem* Item = Bucket->Items.Pop(false);
+			if (IsValid(Item)) {
+				Item->ActivatePickup(Location, Rotation);
+				++NumReused;
+				SLASH_COUNT(PickupsSpawned, 1);
+				return Item;
+			}
+		}
+	}
+
+	AItem* Item = World->SpawnActor<AItem>(ItemClass, Location, Rotation);
+	if (Item) {
+		++NumSpawned;
+		SLASH_COUNT(PickupsSpawned, 1);
+	}
+	return Item;
+}
+
+void UPickupPoolSubsystem::ReleasePickup(AItem* Item) {
+	if (!IsValid(Item)) { return; }
+
+	FPickupPoolBucket& Bucket = PooledPickups.FindOrAdd(Item->GetClass());
+	if (Bucket.Items.Num() >= CVarMaxPooledPickupsPerClass.GetValueOnGameThread()) {
+		Item->Destroy();
+		return;
+	}
+	Item->DeactivatePickup();
+	Bucket.Items.Add(Item);
+}
+
+void UPickupPoolSubsystem::PrewarmPickups(TSubclassOf<AItem> ItemClass, int32 Count) {
+	UWorld* World = GetWorld();
+	if (World == nullptr || ItemClass == nullptr) { return; }
+
+	Count = FMath::Min(Count, CVarMaxPooledPickupsPerClass.GetValueOnGameThread());
+	FPickupPoolBucket& Bucket = PooledPickups.FindOrAdd(ItemClass);
+	while (Bucket.Items.Num() < Count) {
+		AItem* Item = World->SpawnActor<AItem>(ItemClass, FVector::ZeroVector, FRotator::ZeroRotator);
+		if (Item == nullptr) { return; }
+		++NumSpawned;
+		Item->DeactivatePickup();
+		Bucket.Items.Add(Item);
+	}
+}
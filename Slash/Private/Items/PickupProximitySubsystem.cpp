@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/PickupProximitySubsystem.h"
+#include "Items/Item.h"
+#include "Interfaces/PickupInterface.h"
+#include "GameFramework/PlayerController.h"
+#include "Slash/SlashStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Proximity"), STAT_SlashPickupProximity, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickups on Ground"), STAT_SlashPickupsOnGround, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarPickupProximity(
+	TEXT("slash.Items.PickupGrid"),
+	true,
+	TEXT("Find pickups near players with a grid query instead of an overlap sphere per item. Applies to pickups that land after the change"));
+
+void UPickupProximitySubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	SLASH_SET_COUNT(PickupsOnGround, Items.Num());
+	SLASH_SCOPE_HOT_PATH(PickupProximity);
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It) {
+		const APlayerController* PlayerController = It->Get();
+		APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (Pawn && Cast<IPickupInterface>(Pawn)) {
+			UpdateInteractor(Pawn);
+		}
+	}
+	Interactors.RemoveAllSwap([](const FInteractorState& Interactor) { return !Interactor.Pawn.IsValid(); });
+}
+
+TStatId UPickupProximitySubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupProximitySubsystem, STATGROUP_Tickables);
+}
+
+bool UPickupProximitySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UPickupProximitySubsystem::IsProximityEnabled() const {
+	return CVarPickupProximity.GetValueOnGameThread();
+}
+
+void UPickupProximitySubsystem::RegisterItem(AItem* Item, float Radius) {
+	if (Item == nullptr || ItemIndices.Contains(Item)) { return; }
+
+	const FVector Location = Item->GetActorLocation();
+	const FIntPoint Cell = GetCell(Location);
+	const int32 ItemIndex = Items.Add(Item);
+	ItemIndices.Add(Item, ItemIndex);
+	Locations.Add(Location);
+	Radii.Add(Radius);
+	ItemCells.Add(Cell);
+	Cells.FindOrAdd(Cell).Add(ItemIndex);
+	MaxRadius = FMath::Max(MaxRadius, Radius);
+}
+
+void UPickupProximitySubsystem::UnregisterItem(AItem* Item) {
+	int32 ItemIndex = INDEX_NONE;
+	if (!ItemIndices.RemoveAndCopyValue(Item, ItemIndex)) { return; }
+
+	RemoveFromCell(ItemCells[ItemIndex], ItemIndex);
+
+	// The last item is about to be swapped into ItemIndex, so fix up its cell and index
+	const int32 LastIndex = Items.Num() - 1;
+	if (ItemIndex != LastIndex) {
+		ItemIndices.Add(Items[LastIndex], ItemIndex);
+		if (TArray<int32, TInlineAllocator<4>>* CellItems = Cells.Find(ItemCells[LastIndex])) {
+			const int32 Slot = CellItems->Find(LastIndex);
+			if (Slot != INDEX_NONE) {
+				(*CellItems)[Slot] = ItemIndex;
+			}
+		}
+	}
+	Items.RemoveAtSwap(ItemIndex);
+	Locations.RemoveAtSwap(ItemIndex);
+	Radii.RemoveAtSwap(ItemIndex);
+	ItemCells.RemoveAtSwap(ItemIndex);
+}
+
+void UPickupProximitySubsystem::UpdateInteractor(APawn* Pawn) {
+	const FVector Origin = Pawn->GetActorLocation();
+	// The old spheres overlapped the capsule, not just its centre
+	const float PawnRadius = Pawn->GetSimpleCollisionRadius();
+	const double Reach = MaxRadius + PawnRadius;
+
+	// Gathered first, collecting a pickup unregisters it and reshuffles the arrays
+	TArray<TPair<AItem*, double>, TInlineAllocator<16>> InRange;
+	const FIntPoint MinCell = GetCell(Origin - FVector(Reach, Reach, 0.0));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Reach, Reach, 0.0));
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y) {
+			const TArray<int32, TInlineAllocator<4>>* CellItems = Cells.Find(FIntPoint(X, Y));
+			if (CellItems == nullptr) { continue; }
+			for (const int32 ItemIndex : *CellItems) {
+				const double DistSquared = FVector::DistSquared(Origin, Locations[ItemIndex]);
+				if (DistSquared <= FMath::Square(Radii[ItemIndex] + PawnRadius)) {
+					InRange.Emplace(Items[ItemIndex], DistSquared);
+				}
+			}
+		}
+	}
+
+	AItem* NearestItem = nullptr;
+	double NearestDistSquared = TNumericLimits<double>::Max();
+	for (const TPair<AItem*, double>& Candidate : InRange) {
+		AItem* Item = Candidate.Key;
+		if (!IsValid(Item) || Item->TryAutoPickup(Pawn)) { continue; }
+		if (Candidate.Value < NearestDistSquared) {
+			NearestItem = Item;
+			NearestDistSquared = Candidate.Value;
+		}
+	}
+	SetNearestItem(Pawn, NearestItem);
+}
+
+void UPickupProximitySubsystem::SetNearestItem(APawn* Pawn, AItem* NearestItem) {
+	FInteractorState* Interactor = Interactors.FindByPredicate([Pawn](const FInteractorState& State) { return State.Pawn == Pawn; });
+	if (Interactor == nullptr) {
+		Interactor = &Interactors.AddDefaulted_GetRef();
+		Interactor->Pawn = Pawn;
+	}
+	// Only on a change, so the pawn can clear its own overlapping item (e.g. after equipping it)
+	if (Interactor->NearestItem.Get() == NearestItem) { return; }
+
+	Interactor->NearestItem = NearestItem;
+	if (IPickupInterface* PickupInterface = Cast<IPickupInterface>(Pawn)) {
+		PickupInterface->SetOverlappingItem(NearestItem);
+	}
+}
+
+FIntPoint UPickupProximitySubsystem::GetCell(const FVector& Location) const {
+	return FIntPoint(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize)
+	);
+}
+
+void UPickupProximitySubsystem::RemoveFromCell(const FIntPoint& Cell, int32 ItemIndex) {
+	if (TArray<int32, TInlineAllocator<4>>* CellItems = Cells.Find(Cell)) {
+		CellItems->RemoveSingleSwap(ItemIndex);
+		if (CellItems->Num() == 0) {
+			Cells.Remove(Cell);
+		}
+	}
+}
@@ -4,13 +4,22 @@
 #include "Items/Soul.h"
 #include "Interfaces/PickupInterface.h"
 
-void ASoul::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) {
-	IPickupInterface* PickupInterface = Cast<IPickupInterface>(OtherActor);
+bool ASoul::TryAutoPickup(AActor* Interactor) {
+	IPickupInterface* PickupInterface = Cast<IPickupInterface>(Interactor);
 	if (PickupInterface) {
 		PickupInterface->AddSouls(this);
 		SpawnPickupEffect();
 		SpawnPickupSound();
-		Destroy();
+		ConsumePickup();
+		return true;
 	}
-	
+	return false;
+}
+
+int32 ASoul::GetLootValue() const {
+	return Souls;
+}
+
+void ASoul::SetLootValue(int32 Value) {
+	Souls = Value;
 }
@@ -4,11 +4,21 @@
 #include "Items/Treasure.h"
 #include "Interfaces/PickupInterface.h"
 
-void ATreasure::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) {
-	IPickupInterface* PickupInterface = Cast<IPickupInterface>(OtherActor);
+bool ATreasure::TryAutoPickup(AActor* Interactor) {
+	IPickupInterface* PickupInterface = Cast<IPickupInterface>(Interactor);
 	if (PickupInterface) {
 		PickupInterface->AddGold(this);
 		SpawnPickupSound();
-		Destroy();
+		ConsumePickup();
+		return true;
 	}
+	return false;
+}
+
+int32 ATreasure::GetLootValue() const {
+	return Gold;
+}
+
+void ATreasure::SetLootValue(int32 Value) {
+	Gold = Value;
 }
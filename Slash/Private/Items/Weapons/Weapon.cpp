@@ -4,13 +4,33 @@
 #include "Items/Weapons/Weapon.h"
 #include "Characters/SlashCharacter.h"
 #include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "DrawDebugHelpers.h"
 #include "Components/SphereComponent.h"
 #include "Components/BoxComponent.h"
 #include "Interfaces/HitInterface.h"
+#include "Components/FactionComponent.h"
 #include "NiagaraComponent.h"
+#include "Slash/SlashStats.h"
+#include "Combat/CombatDamageSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Weapon Trace"), STAT_SlashWeaponTrace, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon Traces"), STAT_SlashWeaponTraces, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Last Swing Traces"), STAT_SlashWeaponLastSwingTraces, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarWeaponSweepSwings(
+	TEXT("slash.Weapon.SweepSwings"),
+	true,
+	TEXT("Sweep weapon blades between frames while swinging. Turn off to go back to one trace per overlap"));
+
+static TAutoConsoleVariable<bool> CVarWeaponAsyncTraces(
+	TEXT("slash.Weapon.AsyncTraces"),
+	false,
+	TEXT("Run weapon traces through the async trace queue and resolve hits next frame, instead of on the game thread right away"));
 
 AWeapon::AWeapon() {
+	// Sweep after animation has moved the blade for this frame
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
 	WeaponBox = CreateDefaultSubobject<UBoxComponent>(TEXT("WeaponBox"));
 	WeaponBox->SetupAttachment(GetRootComponent());
 	WeaponBox->SetBoxExtent(FVector(2.5, 1.75, 40.f));
@@ -31,14 +51,27 @@ void AWeapon::BeginPlay() {
 	Super::BeginPlay();
 
 	WeaponBox->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::OnBoxOverlap);
+	// UObject binding, so results for a weapon that's been destroyed are never delivered
+	AsyncTraceDelegate.BindUObject(this, &AWeapon::OnAsyncTraceDone);
+}
+
+void AWeapon::Tick(float DeltaTime) {
+	SLASH_BENCHMARK_SCOPE(ESBC_Combat);
+	Super::Tick(DeltaTime);
+
+	if (bSwingActive && IsSweepingSwing()) {
+		SweepSwing();
+	}
 }
 
 void AWeapon::Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOwner, APawn* NewInstigator) {
 	ItemState = EItemState::EIS_Equipped;
+	// Stops ticking too, SetSwingActive only turns it back on for the length of a swing
+	StopHovering();
 	SetOwner(NewOwner);
 	SetInstigator(NewInstigator);
 	AttachMeshToSocket(InParent, InSocketName);
-	DisableSphereCollision();
+	DisablePickup();
 	PlayEquipSound();
 	DeactivateEmbers();
 }
@@ -49,12 +82,6 @@ void AWeapon::DeactivateEmbers() {
 	}
 }
 
-void AWeapon::DisableSphereCollision() {
-	if (Sphere) {
-		Sphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	}
-}
-
 void AWeapon::PlayEquipSound() {
 	if (EquipSound) {
 		UGameplayStatics::PlaySoundAtLocation(
@@ -70,59 +97,226 @@ void AWeapon::AttachMeshToSocket(USceneComponent* InParent, const FName& InSocke
 	ItemMesh->AttachToComponent(InParent, TransformRules, InSocketName);
 }
 
+void AWeapon::SetSwingActive(bool bActive) {
+	if (bSwingActive && !bActive) {
+		NumLastSwingTraces = NumSwingTraces;
+		SLASH_SET_COUNT(WeaponLastSwingTraces, NumLastSwingTraces);
+	}
+	if (bActive && !bSwingActive) {
+		// Kept after the swing ends so async results still in flight don't hit anyone twice
+		HitSet.Reset(this, GetOwner());
+		++SwingId;
+		NumSwingTraces = 0;
+	}
+	bSwingActive = bActive;
+	bHasPrevBlade = false;
+	SetActorTickEnabled(bActive);
+}
+
 void AWeapon::OnBoxOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) {
+	if (IsSweepingSwing()) return; // Tick is already sweeping the blade
 	if (ActorIsSameType(OtherActor)) return;
+
+	if (IsAsyncTracing()) {
+		SubmitAsyncTrace(
+			EAsyncTraceType::Single,
+			BoxTraceStart->GetComponentLocation(),
+			BoxTraceEnd->GetComponentLocation(),
+			BoxTraceStart->GetComponentQuat(),
+			FCollisionShape::MakeBox(BoxTraceExtent)
+		);
+		return;
+	}
 	
 	FHitResult BoxHit;
 	BoxTrace(BoxHit);
 
 	if (BoxHit.GetActor()) {
-		if (ActorIsSameType(BoxHit.GetActor())) return; // No friendly fire by enemies
-		UGameplayStatics::ApplyDamage(BoxHit.GetActor(), Damage, GetInstigator()->GetController(), this, UDamageType::StaticClass());
-		ExecuteGetHit(BoxHit);
-		CreateFields(BoxHit.ImpactPoint);
+		HandleWeaponHit(BoxHit);
+	}
+}
+
+void AWeapon::HandleWeaponHit(FHitResult& BoxHit) {
+	if (ActorIsSameType(BoxHit.GetActor())) return; // No friendly fire by enemies
+
+	UCombatDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCombatDamageSubsystem>();
+	if (DamageSubsystem && DamageSubsystem->IsDeferringDamage()) {
+		DamageSubsystem->QueueDamage(BoxHit.GetActor(), this, Damage, BoxHit.ImpactPoint);
+	} else {
+		ResolveHit(BoxHit.GetActor(), Damage, BoxHit.ImpactPoint);
 	}
 }
 
+void AWeapon::ResolveHit(AActor* Target, float HitDamage, const FVector& ImpactPoint) {
+	SLASH_COMBAT_EVENT(Hit, Target);
+	APawn* WeaponInstigator = GetInstigator();
+	UGameplayStatics::ApplyDamage(Target, HitDamage, WeaponInstigator ? WeaponInstigator->GetController() : nullptr, this, UDamageType::StaticClass());
+	ExecuteGetHit(Target, ImpactPoint);
+	CreateFields(ImpactPoint);
+}
+
 bool AWeapon::ActorIsSameType(AActor* OtherActor) {
-	return GetOwner()->ActorHasTag(TEXT("Enemy")) && OtherActor->ActorHasTag(TEXT("Enemy"));
+	const UFactionComponent* OwnerFaction = UFactionComponent::FindFaction(GetOwner());
+	return OwnerFaction && OwnerFaction->IsSameTeam(UFactionComponent::FindFaction(OtherActor));
 }
 
-void AWeapon::ExecuteGetHit(FHitResult& BoxHit) {
-	IHitInterface* HitInterface = Cast<IHitInterface>(BoxHit.GetActor());
+void AWeapon::ExecuteGetHit(AActor* Target, const FVector& ImpactPoint) {
+	IHitInterface* HitInterface = Cast<IHitInterface>(Target);
 	if (HitInterface) {
-		HitInterface->Execute_GetHit(BoxHit.GetActor(), BoxHit.ImpactPoint, GetOwner());
+		HitInterface->Execute_GetHit(Target, ImpactPoint, GetOwner());
 	}
 }
 
 void AWeapon::BoxTrace(FHitResult& BoxHit) {
+	SLASH_SCOPE_HOT_PATH(WeaponTrace);
+	SLASH_BENCHMARK_SCOPE(ESBC_Combat);
+	SLASH_COUNT(WeaponTraces, 1);
 	const FVector Start = BoxTraceStart->GetComponentLocation();
 	const FVector End = BoxTraceEnd->GetComponentLocation();
+	const FQuat Rotation = BoxTraceStart->GetComponentQuat();
 
-	/** TArray is UnrealEngine's built in array type. Reason to use is because it
-	* can be dynamic. It also has AddUnique which is a smarter Add. Also has
-	* Empty function to clear out array
-	*/
-	TArray<AActor*> ActorsToIgnore;
-	ActorsToIgnore.Add(this); // not really necessary since there is a bIgnoreSelf for this function
-	ActorsToIgnore.Add(GetOwner());
-	for (AActor* Actor : IgnoreActors) {
-		ActorsToIgnore.AddUnique(Actor);
+	// Hit set already ignores us, our owner and everything hit this swing
+	GetWorld()->SweepSingleByChannel(
+		BoxHit,
+		Start,
+		End,
+		Rotation,
+		ECollisionChannel::ECC_Visibility,
+		FCollisionShape::MakeBox(BoxTraceExtent),
+		HitSet.GetQueryParams()
+	);
+	DrawTraceDebug(Start, End, Rotation, BoxTraceExtent, BoxHit.bBlockingHit);
+
+	HitSet.Add(BoxHit.GetActor());
+}
+
+bool AWeapon::IsSweepingSwing() const {
+	return bSweepSwing && CVarWeaponSweepSwings.GetValueOnGameThread();
+}
+
+void AWeapon::SweepSwing() {
+	const FVector BladeStart = BoxTraceStart->GetComponentLocation();
+	const FVector BladeEnd = BoxTraceEnd->GetComponentLocation();
+	if (!bHasPrevBlade) {
+		// First frame of the swing just checks where the blade is
+		PrevBladeStart = BladeStart;
+		PrevBladeEnd = BladeEnd;
+		bHasPrevBlade = true;
+	}
+
+	// One box covering the whole blade, BoxTraceExtent thick
+	const FVector Axis = BladeEnd - BladeStart;
+	const FVector HalfSize(Axis.Size() * 0.5 + BoxTraceExtent.X, BoxTraceExtent.Y, BoxTraceExtent.Z);
+	const FQuat PrevRotation = FRotationMatrix::MakeFromX(PrevBladeEnd - PrevBladeStart).ToQuat();
+	const FQuat Rotation = FRotationMatrix::MakeFromX(Axis).ToQuat();
+	const FVector PrevCenter = (PrevBladeStart + PrevBladeEnd) * 0.5;
+	const FVector Center = (BladeStart + BladeEnd) * 0.5;
+
+	// A sweep can't rotate, so big swings get split up and each piece uses its middle rotation
+	const float AngleDegrees = FMath::RadiansToDegrees(PrevRotation.AngularDistance(Rotation));
+	const int32 NumSweeps = FMath::Clamp(FMath::CeilToInt(AngleDegrees / SweepMaxAngleStep), 1, MaxSweepsPerFrame);
+	for (int32 SweepIndex = 0; SweepIndex < NumSweeps && NumSwingTraces < MaxTracesPerSwing; ++SweepIndex) {
+		const float From = static_cast<float>(SweepIndex) / NumSweeps;
+		const float To = static_cast<float>(SweepIndex + 1) / NumSweeps;
+		const FQuat SweepRotation = FQuat::Slerp(PrevRotation, Rotation, (From + To) * 0.5f);
+		SweepBlade(FMath::Lerp(PrevCenter, Center, From), FMath::Lerp(PrevCenter, Center, To), SweepRotation, HalfSize);
+	}
+
+	PrevBladeStart = BladeStart;
+	PrevBladeEnd = BladeEnd;
+}
+
+void AWeapon::SweepBlade(const FVector& FromCenter, const FVector& ToCenter, const FQuat& Rotation, const FVector& HalfSize) {
+	if (IsAsyncTracing()) {
+		SubmitAsyncTrace(EAsyncTraceType::Multi, FromCenter, ToCenter, Rotation, FCollisionShape::MakeBox(HalfSize));
+		return;
 	}
 
-	UKismetSystemLibrary::BoxTraceSingle(
-		this,
+	SLASH_SCOPE_HOT_PATH(WeaponTrace);
+
+	// The trace stops at the first thing that blocks it, so go again past it to reach the rest of a crowd
+	while (NumSwingTraces < MaxTracesPerSwing) {
+		++NumSwingTraces;
+		SLASH_COUNT(WeaponTraces, 1);
+
+		TArray<FHitResult, TInlineAllocator<8>> Hits;
+		GetWorld()->SweepMultiByChannel(
+			Hits,
+			FromCenter,
+			ToCenter,
+			Rotation,
+			ECollisionChannel::ECC_Visibility,
+			FCollisionShape::MakeBox(HalfSize),
+			HitSet.GetQueryParams()
+		);
+		DrawTraceDebug(FromCenter, ToCenter, Rotation, HalfSize, Hits.Num() > 0);
+
+		if (!HandleSweepHits(Hits)) break;
+	}
+}
+
+bool AWeapon::HandleSweepHits(TArrayView<FHitResult> Hits) {
+	bool bBlockedByTarget = false;
+	for (FHitResult& Hit : Hits) {
+		AActor* HitActor = Hit.GetActor();
+		// Async results can name a target destroyed in the frame between submit and now
+		if (HitActor && !IsValid(HitActor)) continue;
+		// Walls, floors and props stop the blade, nothing behind them gets hit
+		if (!IsSwingTarget(HitActor)) {
+			if (Hit.bBlockingHit) { return false; }
+			continue;
+		}
+		// Anything hit earlier in the swing is already ignored by the trace, this just skips actors with several hit components
+		if (!HitSet.Add(HitActor)) continue;
+		bBlockedByTarget |= Hit.bBlockingHit;
+		HandleWeaponHit(Hit);
+	}
+	return bBlockedByTarget;
+}
+
+bool AWeapon::IsSwingTarget(const AActor* Actor) {
+	return Actor && (Actor->IsA<APawn>() || Actor->Implements<UHitInterface>());
+}
+
+bool AWeapon::IsAsyncTracing() const {
+	return CVarWeaponAsyncTraces.GetValueOnGameThread();
+}
+
+void AWeapon::SubmitAsyncTrace(EAsyncTraceType TraceType, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape) {
+	if (NumSwingTraces >= MaxTracesPerSwing) { return; }
+	++NumSwingTraces;
+	SLASH_COUNT(WeaponTraces, 1);
+
+	// Params are copied when the trace is queued, anything hit before the results come back is caught by the hit set
+	GetWorld()->AsyncSweepByChannel(
+		TraceType,
 		Start,
 		End,
-		BoxTraceExtent,
-		BoxTraceStart->GetComponentRotation(),
-		ETraceTypeQuery::TraceTypeQuery1,
-		false,
-		ActorsToIgnore,
-		bShowBoxDebug ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None,
-		BoxHit,
-		true
+		Rotation,
+		ECollisionChannel::ECC_Visibility,
+		Shape,
+		HitSet.GetQueryParams(),
+		FCollisionResponseParams::DefaultResponseParam,
+		&AsyncTraceDelegate,
+		SwingId
 	);
+}
+
+void AWeapon::OnAsyncTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum) {
+	if (TraceDatum.UserData != SwingId) return; // A newer swing has started since
+	if (UFactionComponent::ActorHasFlags(GetOwner(), EFactionFlags::EFF_Dead)) return; // Died before the blade connected
+	DrawTraceDebug(TraceDatum.Start, TraceDatum.End, TraceDatum.Rot, TraceDatum.CollisionParams.CollisionShape.GetExtent(), TraceDatum.OutHits.Num() > 0);
 
-	IgnoreActors.AddUnique(BoxHit.GetActor());
+	const bool bBlockedByTarget = HandleSweepHits(TraceDatum.OutHits);
+
+	// Same as the sync sweep, go again past a target that blocked it but never past the world
+	if (bBlockedByTarget && TraceDatum.TraceType == EAsyncTraceType::Multi) {
+		SubmitAsyncTrace(EAsyncTraceType::Multi, TraceDatum.Start, TraceDatum.End, TraceDatum.Rot, TraceDatum.CollisionParams.CollisionShape);
+	}
+}
+
+void AWeapon::DrawTraceDebug(const FVector& Start, const FVector& End, const FQuat& Rotation, const FVector& HalfSize, bool bHit) const {
+	if (bShowBoxDebug) {
+		DrawDebugSweptBox(GetWorld(), Start, End, Rotation.Rotator(), HalfSize, bHit ? FColor::Green : FColor::Red, false, 5.f);
+	}
 }
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/CombatBenchmark.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CombatBenchmarkTest {
+	static constexpr int64 NumExchanges = 100000;
+	static constexpr int32 Seed = 1;
+	// Wide enough that tuning a number a little doesn't fail it, narrow enough that a broken rule does
+	static constexpr int64 MinKills = 1500;
+	static constexpr int64 MaxKills = 3000;
+	static constexpr int64 MinDeaths = 250;
+	static constexpr int64 MaxDeaths = 550;
+	static constexpr int64 MinDodges = 1400;
+	static constexpr int64 MaxDodges = 2800;
+	// Health over damage, the undodged hits it takes to kill the player
+	static constexpr int64 HitsPerPlayerDeath = 5;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatBenchmarkTest, "Slash.Combat.Benchmark.FixedSeed", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCombatBenchmarkTest::RunTest(const FString& Parameters) {
+	using namespace CombatBenchmarkTest;
+
+	const FCombatBenchmark::FResult Result = FCombatBenchmark::Run(NumExchanges, Seed);
+	const FCombatBenchmark::FResult Again = FCombatBenchmark::Run(NumExchanges, Seed);
+
+	// Same seed, same fight
+	TestEqual(TEXT("Kills repeat with the same seed"), Again.EnemyKills, Result.EnemyKills);
+	TestEqual(TEXT("Deaths repeat with the same seed"), Again.PlayerDeaths, Result.PlayerDeaths);
+	TestEqual(TEXT("Dodges repeat with the same seed"), Again.Dodges, Result.Dodges);
+	TestEqual(TEXT("Enemy attacks repeat with the same seed"), Again.EnemyAttacks, Result.EnemyAttacks);
+
+	TestTrue(FString::Printf(TEXT("Enemy kills in range (%lld)"), Result.EnemyKills), Result.EnemyKills >= MinKills && Result.EnemyKills <= MaxKills);
+	TestTrue(FString::Printf(TEXT("Player deaths in range (%lld)"), Result.PlayerDeaths), Result.PlayerDeaths >= MinDeaths && Result.PlayerDeaths <= MaxDeaths);
+	TestTrue(FString::Printf(TEXT("Dodges in range (%lld)"), Result.Dodges), Result.Dodges >= MinDodges && Result.Dodges <= MaxDodges);
+
+	TestTrue(TEXT("Only attacks get dodged"), Result.Dodges <= Result.EnemyAttacks);
+	TestTrue(TEXT("Every player death took enough hits"), Result.PlayerDeaths * HitsPerPlayerDeath <= Result.EnemyAttacks - Result.Dodges);
+	TestTrue(TEXT("Enemies lose interest when the player wanders off"), Result.LostInterest > 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Tests/SlashTestWorld.h"
+#include "Combat/CombatGridSubsystem.h"
+#include "GameFramework/Pawn.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CombatGridPerfTest {
+	// Same as the enemy's pawn sensing
+	static constexpr double SightRadius = 4000.0;
+	static constexpr float PeripheralVisionCosine = 0.5f;
+	// Space per pawn, the map grows with the count so density stays the same
+	static constexpr double Spacing = 1500.0;
+	static constexpr int32 NumRepeats = 20;
+	// Per enemy cost is allowed to wobble with cache effects, not to scale with the count
+	static constexpr double MaxCostGrowth = 3.0;
+
+	struct FSample {
+		FVector Origin;
+		FVector Forward;
+	};
+
+	static APawn* SpawnPawn(UWorld* World, const FVector& Location) {
+		APawn* Pawn = World->SpawnActor<APawn>(APawn::StaticClass(), FTransform::Identity);
+		USceneComponent* Root = NewObject<USceneComponent>(Pawn, TEXT("Root"));
+		Pawn->SetRootComponent(Root);
+		Root->RegisterComponent();
+		Pawn->SetActorLocation(Location);
+		return Pawn;
+	}
+
+	/* Nanoseconds per enemy for one sight query each, through the grid and through a scan of every target */
+	static void MeasureSightQueries(FAutomationTestBase& Test, int32 NumEnemies, double& OutGridNs, double& OutScanNs) {
+		FSlashTestWorld TestWorld;
+		UWorld* World = TestWorld.World;
+		UCombatGridSubsystem* CombatGrid = World->GetSubsystem<UCombatGridSubsystem>();
+
+		FRandomStream Random(NumEnemies);
+		const double HalfExtent = FMath::Sqrt((double)NumEnemies) * Spacing * 0.5;
+		auto RandomLocation = [&Random, HalfExtent]() {
+			return FVector(Random.FRandRange(-HalfExtent, HalfExtent), Random.FRandRange(-HalfExtent, HalfExtent), 0.0);
+		};
+
+		TArray<APawn*> Targets;
+		for (int32 Index = 0; Index < NumEnemies; ++Index) {
+			APawn* Target = SpawnPawn(World, RandomLocation());
+			CombatGrid->RegisterTarget(Target);
+			Targets.Add(Target);
+		}
+		TestWorld.Tick();
+
+		TArray<FSample> Samples;
+		for (int32 Index = 0; Index < NumEnemies; ++Index) {
+			Samples.Add({ RandomLocation(), FRotator(0.f, Random.FRandRange(-180.f, 180.f), 0.f).Vector() });
+		}
+
+		// What every enemy did before the grid, check each target in the world
+		auto ScanTargets = [&Targets](const FSample& Sample) {
+			APawn* NearestTarget = nullptr;
+			double NearestDistSquared = FMath::Square(SightRadius);
+			for (APawn* Target : Targets) {
+				const FVector ToTarget = Target->GetActorLocation() - Sample.Origin;
+				const double DistSquared = ToTarget.SizeSquared();
+				if (DistSquared > NearestDistSquared) { continue; }
+				if (FVector::DotProduct(Sample.Forward, ToTarget.GetSafeNormal()) < PeripheralVisionCosine) { continue; }
+				NearestTarget = Target;
+				NearestDistSquared = DistSquared;
+			}
+			return NearestTarget;
+		};
+
+		int32 NumMismatches = 0;
+		for (const FSample& Sample : Samples) {
+			if (CombatGrid->FindNearestTargetInView(Sample.Origin, Sample.Forward, SightRadius, PeripheralVisionCosine) != ScanTargets(Sample)) {
+				++NumMismatches;
+			}
+		}
+		Test.TestEqual(FString::Printf(TEXT("Grid and scan disagree on nearest target with %d enemies"), NumEnemies), NumMismatches, 0);
+
+		int32 NumFound = 0;
+		const double GridStart = FPlatformTime::Seconds();
+		for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat) {
+			for (const FSample& Sample : Samples) {
+				NumFound += CombatGrid->FindNearestTargetInView(Sample.Origin, Sample.Forward, SightRadius, PeripheralVisionCosine) != nullptr;
+			}
+		}
+		const double GridSeconds = FPlatformTime::Seconds() - GridStart;
+
+		const double ScanStart = FPlatformTime::Seconds();
+		for (int32 Repeat = 0; Repeat < NumRepeats; ++Repeat) {
+			for (const FSample& Sample : Samples) {
+				NumFound += ScanTargets(Sample) != nullptr;
+			}
+		}
+		const double ScanSeconds = FPlatformTime::Seconds() - ScanStart;
+
+		const double NumQueries = (double)NumEnemies * NumRepeats;
+		OutGridNs = GridSeconds * 1e9 / NumQueries;
+		OutScanNs = ScanSeconds * 1e9 / NumQueries;
+		Test.AddInfo(FString::Printf(TEXT("%5d enemies: grid %8.1f ns/enemy, scan %8.1f ns/enemy (%d found)"), NumEnemies, OutGridNs, OutScanNs, NumFound));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatGridPerfTest, "Slash.Combat.Grid.SightQueryScaling", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FCombatGridPerfTest::RunTest(const FString& Parameters) {
+	using namespace CombatGridPerfTest;
+
+	double SmallestGridNs = 0.0;
+	double SmallestScanNs = 0.0;
+	for (const int32 NumEnemies : { 100, 500, 2000 }) {
+		double GridNs = 0.0;
+		double ScanNs = 0.0;
+		MeasureSightQueries(*this, NumEnemies, GridNs, ScanNs);
+		if (SmallestGridNs == 0.0) {
+			SmallestGridNs = GridNs;
+			SmallestScanNs = ScanNs;
+			continue;
+		}
+
+		// Wall clock on a shared machine is too noisy to fail on
+		if (GridNs > SmallestGridNs * MaxCostGrowth) {
+			AddWarning(FString::Printf(TEXT("Grid cost per enemy grew x%.2f by %d enemies (%.1f ns vs %.1f ns at the smallest count)"), GridNs / SmallestGridNs, NumEnemies, GridNs, SmallestGridNs));
+		}
+		AddInfo(FString::Printf(TEXT("%5d enemies: grid x%.2f, scan x%.2f per enemy vs the smallest count"), NumEnemies, GridNs / SmallestGridNs, ScanNs / SmallestScanNs));
+	}
+	return true;
+}
+
+#endif
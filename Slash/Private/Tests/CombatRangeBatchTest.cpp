@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/CombatRangeBatch.h"
+#include "Combat/CombatRules.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CombatRangeBatchTest {
+	struct FCase {
+		FVector Location;
+		FVector TargetLocation;
+		double AttackRadius;
+		double CombatRadius;
+		bool bHasTarget;
+	};
+
+	// What AEnemy works out one predicate at a time, IsOutsideCombatRadius first
+	static ECombatRangeBand ScalarBand(const FCase& Case) {
+		if (!Case.bHasTarget) { return ECombatRangeBand::ECRB_Outside; }
+		if (!FCombatRules::IsInRange(Case.Location, Case.TargetLocation, Case.CombatRadius)) { return ECombatRangeBand::ECRB_Outside; }
+		if (FCombatRules::IsInRange(Case.Location, Case.TargetLocation, Case.AttackRadius)) { return ECombatRangeBand::ECRB_InsideAttack; }
+		return ECombatRangeBand::ECRB_InsideCombat;
+	}
+
+	static void AddBoundaryCases(TArray<FCase>& Cases) {
+		const FVector Origin(120.0, -40.0, 15.0);
+		const double AttackRadius = 150.0;
+		const double CombatRadius = 500.0;
+		// Axis aligned offsets keep the squared distance exact, so on the radius really is on it
+		for (const FVector& Axis : { FVector::XAxisVector, FVector::YAxisVector, FVector::ZAxisVector, -FVector::XAxisVector }) {
+			for (const double Distance : { 0.0, AttackRadius - 1.0, AttackRadius, AttackRadius + 1.0, CombatRadius - 1.0, CombatRadius, CombatRadius + 1.0 }) {
+				Cases.Add({ Origin, Origin + Axis * Distance, AttackRadius, CombatRadius, true });
+			}
+		}
+		// Degenerate radii, attack radius bigger than combat radius and zero radii
+		Cases.Add({ Origin, Origin + FVector(300.0, 0.0, 0.0), 400.0, 200.0, true });
+		Cases.Add({ Origin, Origin + FVector(100.0, 0.0, 0.0), 400.0, 200.0, true });
+		Cases.Add({ Origin, Origin, 0.0, 0.0, true });
+		Cases.Add({ Origin, Origin + FVector(1.0, 0.0, 0.0), 0.0, 0.0, true });
+	}
+
+	static void AddNoTargetCases(TArray<FCase>& Cases) {
+		// Whatever was left in the entry, no target is always outside
+		Cases.Add({ FVector::ZeroVector, FVector::ZeroVector, 150.0, 500.0, false });
+		Cases.Add({ FVector(10.0), FVector(10.0), 1000.0, 1000.0, false });
+	}
+
+	static void AddRandomCases(TArray<FCase>& Cases, int32 Num) {
+		FRandomStream Random(4242);
+		for (int32 Index = 0; Index < Num; ++Index) {
+			const FVector Location(Random.FRandRange(-50000.0, 50000.0), Random.FRandRange(-50000.0, 50000.0), Random.FRandRange(-500.0, 500.0));
+			const FVector Offset = Random.GetUnitVector() * Random.FRandRange(0.0, 2000.0);
+			const double AttackRadius = Random.FRandRange(50.0, 400.0);
+			const double CombatRadius = Random.FRandRange(AttackRadius, 1500.0);
+			Cases.Add({ Location, Location + Offset, AttackRadius, CombatRadius, Random.FRand() > 0.1f });
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatRangeBatchTest, "Slash.Combat.RangeBatch", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCombatRangeBatchTest::RunTest(const FString& Parameters) {
+	using namespace CombatRangeBatchTest;
+
+	TArray<FCase> Cases;
+	AddBoundaryCases(Cases);
+	AddNoTargetCases(Cases);
+	AddRandomCases(Cases, 10000);
+
+	FCombatRangeBatch Batch;
+	Batch.SetNum(Cases.Num());
+	for (int32 Index = 0; Index < Cases.Num(); ++Index) {
+		const FCase& Case = Cases[Index];
+		if (Case.bHasTarget) {
+			Batch.SetEntry(Index, Case.Location, Case.TargetLocation, Case.AttackRadius, Case.CombatRadius);
+		} else {
+			Batch.SetEntryNoTarget(Index);
+		}
+	}
+	Batch.Classify();
+
+	int32 NumMismatches = 0;
+	for (int32 Index = 0; Index < Cases.Num(); ++Index) {
+		const FCase& Case = Cases[Index];
+		const ECombatRangeBand Expected = ScalarBand(Case);
+		const ECombatRangeBand SingleBand = Case.bHasTarget ?
+			FCombatRangeBatch::ClassifySingle(Case.Location, Case.TargetLocation, Case.AttackRadius, Case.CombatRadius) :
+			ECombatRangeBand::ECRB_Outside;
+		if (Batch.GetBand(Index) == Expected && SingleBand == Expected) { continue; }
+
+		// Only the first few, a broken kernel would otherwise flood the log
+		if (++NumMismatches <= 10) {
+			AddError(FString::Printf(TEXT("Case %d: batch %d, single %d, scalar %d (distance %.3f, attack %.3f, combat %.3f)"),
+				Index, (int32)Batch.GetBand(Index), (int32)SingleBand, (int32)Expected,
+				FVector::Dist(Case.Location, Case.TargetLocation), Case.AttackRadius, Case.CombatRadius));
+		}
+	}
+	TestEqual(TEXT("Batch and scalar range bands disagree"), NumMismatches, 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Tests/SlashTestWorld.h"
+#include "Enemy/Enemy.h"
+#include "Enemy/EnemyBenchmarkSubsystem.h"
+#include "Characters/SlashCharacter.h"
+#include "Misc/AutomationTest.h"
+#include "Slash/SlashStats.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && SLASH_INSTRUMENTATION
+
+namespace EnemyScalingPerfTest {
+	static constexpr float RunSeconds = 3.f;
+	static constexpr float TickSeconds = 1.f / 30.f;
+	// Warmup plus the recorded frames for every count, with room to spare
+	static constexpr int32 MaxFrames = 2000;
+	// Per enemy cost is allowed to wobble, not to scale with the count
+	static constexpr double MaxCostGrowth = 3.0;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEnemyScalingPerfTest, "Slash.Enemy.Benchmark.EnemyScaling", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FEnemyScalingPerfTest::RunTest(const FString& Parameters) {
+	using namespace EnemyScalingPerfTest;
+
+	FSlashTestWorld TestWorld;
+	UWorld* World = TestWorld.World;
+	UEnemyBenchmarkSubsystem* Benchmark = World->GetSubsystem<UEnemyBenchmarkSubsystem>();
+	if (!TestNotNull(TEXT("Benchmark subsystem"), Benchmark)) { return false; }
+
+	// The test world has no player controller, so an unpossessed player character stands in as the target
+	ASlashCharacter* Target = World->SpawnActor<ASlashCharacter>(ASlashCharacter::StaticClass(), FTransform::Identity);
+	if (!TestNotNull(TEXT("Target character"), Target)) { return false; }
+
+	const TArray<int32> EnemyCounts = { 25, 100, 400 };
+	if (!TestTrue(TEXT("Benchmark starts"), Benchmark->StartBenchmark(AEnemy::StaticClass(), EnemyCounts, RunSeconds, Target))) { return false; }
+
+	for (int32 Frame = 0; Frame < MaxFrames && Benchmark->IsRunning(); ++Frame) {
+		TestWorld.Tick(TickSeconds);
+	}
+	TestFalse(TEXT("Benchmark finished"), Benchmark->IsRunning());
+
+	const TArray<FEnemyBenchmarkRun>& Results = Benchmark->GetResults();
+	if (!TestEqual(TEXT("One result per enemy count"), Results.Num(), EnemyCounts.Num())) { return false; }
+
+	double SmallestAIUs = 0.0;
+	for (const FEnemyBenchmarkRun& Run : Results) {
+		TestEqual(FString::Printf(TEXT("Every enemy spawned for the %d run"), Run.NumEnemies), Run.NumSpawned, Run.NumEnemies);
+		TestTrue(FString::Printf(TEXT("Frames recorded for the %d run"), Run.NumEnemies), Run.Frames > 0);
+		TestTrue(FString::Printf(TEXT("Simulated time matches the recorded frames for the %d run"), Run.NumEnemies),
+			FMath::IsNearlyEqual(Run.SimulatedSeconds, Run.Frames * TickSeconds, 0.01));
+		// Enemies have to notice the target and fight it, or this only measures patrolling
+		TestTrue(FString::Printf(TEXT("Enemies went after the target in the %d run"), Run.NumEnemies), Run.MaxEnemiesInCombat > 0);
+		if (Run.Frames == 0 || Run.NumSpawned == 0) { continue; }
+
+		const double Frames = Run.Frames;
+		const double AIUs = Run.AIMs * 1000.0 / Frames / Run.NumSpawned;
+		AddInfo(FString::Printf(TEXT("%4d enemies: %.2fms/frame, AI %.2fus/enemy, move scheduler %.2fus/enemy, movement %.2fus/enemy, combat %.2fus/enemy"),
+			Run.NumSpawned, Run.FrameMs / Frames, AIUs,
+			Run.MoveSchedulerMs * 1000.0 / Frames / Run.NumSpawned, Run.MovementMs * 1000.0 / Frames / Run.NumSpawned,
+			Run.CombatMs * 1000.0 / Frames / Run.NumSpawned));
+
+		if (SmallestAIUs == 0.0) {
+			SmallestAIUs = AIUs;
+		} else if (AIUs > SmallestAIUs * MaxCostGrowth) {
+			AddWarning(FString::Printf(TEXT("AI cost per enemy grew x%.2f by %d enemies"), AIUs / SmallestAIUs, Run.NumSpawned));
+		}
+	}
+	return true;
+}
+
+#endif
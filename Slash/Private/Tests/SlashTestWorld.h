@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+* A bare game world for automation tests, with physics, the world subsystems
+* and BeginPlay already dispatched, so spawned actors behave like they do in
+* a level. Torn down when it goes out of scope
+*/
+struct FSlashTestWorld {
+	FSlashTestWorld() {
+		World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SlashTestWorld"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+		// There's no game mode to start play, so hand out BeginPlay ourselves
+		World->GetWorldSettings()->NotifyBeginPlay();
+	}
+
+	~FSlashTestWorld() {
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	void Tick(float DeltaSeconds = 1.f / 30.f) {
+		World->Tick(LEVELTICK_All, DeltaSeconds);
+	}
+
+	UWorld* World = nullptr;
+};
+
+#endif
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Tests/SlashTestWorld.h"
+#include "Items/Weapons/WeaponHitSet.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace WeaponHitSetPerfTest {
+	// Roughly the same number of traces for every target count
+	static constexpr int32 TracesPerRun = 200000;
+
+	/* The weapon's bookkeeping before the hit set: an array of everyone hit, copied into a fresh ignore list for every trace */
+	struct FIgnoreActorsPath {
+		void Reset() {
+			IgnoreActors.Empty();
+		}
+
+		int32 Trace(AActor* Weapon, AActor* Wielder, AActor* Hit) {
+			TArray<AActor*> ActorsToIgnore;
+			ActorsToIgnore.Add(Weapon);
+			ActorsToIgnore.Add(Wielder);
+			for (AActor* Actor : IgnoreActors) {
+				ActorsToIgnore.AddUnique(Actor);
+			}
+			// What UKismetSystemLibrary::BoxTraceSingle built from that list before every sweep
+			FCollisionQueryParams Params(SCENE_QUERY_STAT(BoxTraceSingle), false);
+			Params.bReturnPhysicalMaterial = true;
+			Params.AddIgnoredActors(ActorsToIgnore);
+
+			IgnoreActors.AddUnique(Hit);
+			return Params.GetIgnoredActors().Num();
+		}
+
+		bool Contains(const AActor* Actor) const { return IgnoreActors.Contains(Actor); }
+
+		TArray<AActor*> IgnoreActors;
+	};
+
+	struct FHitSetPath {
+		void Reset(AActor* Weapon, AActor* Wielder) {
+			HitSet.Reset(Weapon, Wielder);
+		}
+
+		int32 Trace(AActor* Hit) {
+			const int32 NumIgnored = HitSet.GetQueryParams().GetIgnoredActors().Num();
+			HitSet.Add(Hit);
+			return NumIgnored;
+		}
+
+		FWeaponHitSet HitSet;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponHitSetTest, "Slash.Combat.WeaponTrace.HitSetRejectsDuplicates", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FWeaponHitSetTest::RunTest(const FString& Parameters) {
+	FSlashTestWorld TestWorld;
+	UWorld* World = TestWorld.World;
+	AActor* Weapon = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity);
+	AActor* Wielder = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity);
+
+	// Past the inline storage too, spilling to the heap mustn't forget anyone
+	TArray<AActor*> Targets;
+	for (int32 Index = 0; Index < FWeaponHitSet::InlineCapacity * 2; ++Index) {
+		Targets.Add(World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity));
+	}
+
+	FWeaponHitSet HitSet;
+	HitSet.Reset(Weapon, Wielder);
+	TestFalse(TEXT("Nothing is hit by a null actor"), HitSet.Add(nullptr));
+
+	// Every sweep of a swing sees the same targets again, only the first one counts
+	int32 NumFirstHits = 0;
+	int32 NumRepeatHits = 0;
+	for (int32 Sweep = 0; Sweep < 3; ++Sweep) {
+		for (AActor* Target : Targets) {
+			if (HitSet.Add(Target)) {
+				++NumFirstHits;
+			} else {
+				++NumRepeatHits;
+			}
+		}
+	}
+	TestEqual(TEXT("Each target is hit once per swing"), NumFirstHits, Targets.Num());
+	TestEqual(TEXT("Repeat hits are rejected"), NumRepeatHits, Targets.Num() * 2);
+	TestEqual(TEXT("Hit set holds every target once"), HitSet.Num(), Targets.Num());
+	// Weapon, wielder and every target, no duplicates handed to the sweep
+	TestEqual(TEXT("Ignore list holds every target once"), HitSet.GetQueryParams().GetIgnoredActors().Num(), Targets.Num() + 2);
+
+	HitSet.Reset(Weapon, Wielder);
+	TestEqual(TEXT("A new swing starts empty"), HitSet.Num(), 0);
+	TestTrue(TEXT("A new swing can hit the same target again"), HitSet.Add(Targets[0]));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponHitSetPerfTest, "Slash.Combat.WeaponTrace.HitSetBookkeeping", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FWeaponHitSetPerfTest::RunTest(const FString& Parameters) {
+	using namespace WeaponHitSetPerfTest;
+
+	FSlashTestWorld TestWorld;
+	UWorld* World = TestWorld.World;
+	AActor* Weapon = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity);
+	AActor* Wielder = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity);
+
+	for (const int32 NumTargets : { 1, 8, 32 }) {
+		TArray<AActor*> Targets;
+		for (int32 Index = 0; Index < NumTargets; ++Index) {
+			Targets.Add(World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity));
+		}
+		// A swing traces every target, each one blocking the trace until it's ignored
+		const int32 NumSwings = FMath::Max(1, TracesPerRun / NumTargets);
+
+		FIgnoreActorsPath OldPath;
+		int64 OldIgnored = 0;
+		const uint64 OldStart = FPlatformTime::Cycles64();
+		for (int32 Swing = 0; Swing < NumSwings; ++Swing) {
+			OldPath.Reset();
+			for (AActor* Target : Targets) {
+				OldIgnored += OldPath.Trace(Weapon, Wielder, Target);
+			}
+		}
+		const double OldSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - OldStart);
+
+		FHitSetPath NewPath;
+		int64 NewIgnored = 0;
+		const uint64 NewStart = FPlatformTime::Cycles64();
+		for (int32 Swing = 0; Swing < NumSwings; ++Swing) {
+			NewPath.Reset(Weapon, Wielder);
+			for (AActor* Target : Targets) {
+				NewIgnored += NewPath.Trace(Target);
+			}
+		}
+		const double NewSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - NewStart);
+
+		// Both have to hand the sweep the same ignore list and remember the same hits
+		TestEqual(FString::Printf(TEXT("Ignore list sizes match with %d targets"), NumTargets), NewIgnored, OldIgnored);
+		bool bSameHits = NewPath.HitSet.Num() == OldPath.IgnoreActors.Num();
+		for (AActor* Target : Targets) {
+			bSameHits &= NewPath.HitSet.Contains(Target) == OldPath.Contains(Target);
+		}
+		TestTrue(FString::Printf(TEXT("Hit set remembers the same hits as the array with %d targets"), NumTargets), bSameHits);
+
+		const double NumTraces = (double)NumSwings * NumTargets;
+		const double OldNs = OldSeconds * 1e9 / NumTraces;
+		const double NewNs = NewSeconds * 1e9 / NumTraces;
+		AddInfo(FString::Printf(TEXT("%2d targets: IgnoreActors %7.1f ns/trace, hit set %7.1f ns/trace (x%.2f)"), NumTargets, OldNs, NewNs, OldNs / FMath::Max(NewNs, UE_SMALL_NUMBER)));
+		if (NumTargets > 1 && NewNs > OldNs) {
+			AddWarning(FString::Printf(TEXT("Hit set is slower than the IgnoreActors array with %d targets"), NumTargets));
+		}
+	}
+	return true;
+}
+
+#endif
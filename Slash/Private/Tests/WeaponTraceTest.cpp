@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Tests/SlashTestWorld.h"
+#include "Items/Weapons/Weapon.h"
+#include "Components/BoxComponent.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace WeaponTraceTest {
+	static constexpr double BladeStart = 20.0;
+	static constexpr double BladeEnd = 100.0;
+	static constexpr double TargetRadius = 60.0;
+	static constexpr float SwingFromYaw = -90.f;
+	static constexpr float SwingToYaw = 90.f;
+	static constexpr float SwingStepYaw = 15.f;
+	// Async results come back a frame or two after they're queued
+	static constexpr int32 SettleFrames = 4;
+
+	// Pawns, so the blade sweeps on past them like it does through a crowd of enemies
+	static AActor* SpawnTarget(UWorld* World, const FVector& Location) {
+		AActor* Target = World->SpawnActor<APawn>(APawn::StaticClass(), FTransform::Identity);
+		UBoxComponent* Box = NewObject<UBoxComponent>(Target, TEXT("TargetBox"));
+		Box->SetBoxExtent(FVector(15.f));
+		Box->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+		Box->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Block);
+		Target->SetRootComponent(Box);
+		Box->RegisterComponent();
+		Target->SetActorLocation(Location);
+		return Target;
+	}
+
+	/* Fixed target layout, index order is the same in every world */
+	static TArray<AActor*> SpawnTargets(UWorld* World, int32& OutNumInReach) {
+		TArray<AActor*> Targets;
+		for (float Yaw = -80.f; Yaw <= 80.f; Yaw += 20.f) {
+			Targets.Add(SpawnTarget(World, FRotator(0.f, Yaw, 0.f).Vector() * TargetRadius));
+		}
+		OutNumInReach = Targets.Num();
+		// Past the tip, and behind where the swing starts
+		Targets.Add(SpawnTarget(World, FVector(300.0, 0.0, 0.0)));
+		Targets.Add(SpawnTarget(World, FVector(-TargetRadius, 0.0, 0.0)));
+		return Targets;
+	}
+
+	/* Swings a bare weapon through the targets and returns which of them it hit, by index */
+	static TArray<int32> RunSwing(bool bAsync, int32& OutNumInReach) {
+		IConsoleVariable* AsyncTraces = IConsoleManager::Get().FindConsoleVariable(TEXT("slash.Weapon.AsyncTraces"));
+		const bool bWasAsync = AsyncTraces->GetBool();
+		AsyncTraces->Set(bAsync, ECVF_SetByConsole);
+
+		FSlashTestWorld TestWorld;
+		UWorld* World = TestWorld.World;
+		const TArray<AActor*> Targets = SpawnTargets(World, OutNumInReach);
+
+		AActor* Wielder = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity);
+		USceneComponent* Hand = NewObject<USceneComponent>(Wielder, TEXT("Hand"));
+		Wielder->SetRootComponent(Hand);
+		Hand->RegisterComponent();
+
+		AWeapon* Weapon = World->SpawnActor<AWeapon>(AWeapon::StaticClass(), FTransform::Identity);
+		Weapon->Equip(Hand, NAME_None, Wielder, nullptr);
+		// A bare AWeapon has both trace points on its root, lay the blade out along the hand's X axis
+		TInlineComponentArray<USceneComponent*> Components(Weapon);
+		for (USceneComponent* Component : Components) {
+			if (Component->GetFName() == TEXT("Box Trace Start")) {
+				Component->SetRelativeLocation(FVector(BladeStart, 0.0, 0.0));
+			} else if (Component->GetFName() == TEXT("Box Trace End")) {
+				Component->SetRelativeLocation(FVector(BladeEnd, 0.0, 0.0));
+			}
+		}
+
+		Weapon->SetSwingActive(true);
+		for (float Yaw = SwingFromYaw; Yaw <= SwingToYaw; Yaw += SwingStepYaw) {
+			Wielder->SetActorRotation(FRotator(0.f, Yaw, 0.f));
+			TestWorld.Tick();
+		}
+		for (int32 Frame = 0; Frame < SettleFrames; ++Frame) {
+			TestWorld.Tick();
+		}
+
+		TArray<int32> HitIndices;
+		for (int32 Index = 0; Index < Targets.Num(); ++Index) {
+			if (Weapon->GetHitSet().Contains(Targets[Index])) {
+				HitIndices.Add(Index);
+			}
+		}
+		Weapon->SetSwingActive(false);
+
+		AsyncTraces->Set(bWasAsync, ECVF_SetByConsole);
+		return HitIndices;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponTraceTest, "Slash.Combat.WeaponTrace.SyncMatchesAsync", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FWeaponTraceTest::RunTest(const FString& Parameters) {
+	using namespace WeaponTraceTest;
+
+	int32 NumInReach = 0;
+	const TArray<int32> SyncHits = RunSwing(false, NumInReach);
+	const TArray<int32> AsyncHits = RunSwing(true, NumInReach);
+
+	// Guards against both modes agreeing on nothing because the swing missed everything
+	TestEqual(TEXT("Sync swing hits every target in reach"), SyncHits.Num(), NumInReach);
+	TestFalse(TEXT("Sync swing doesn't reach past the blade"), SyncHits.Contains(NumInReach) || SyncHits.Contains(NumInReach + 1));
+	auto Describe = [](const TArray<int32>& Hits) { return FString::JoinBy(Hits, TEXT(","), [](int32 Index) { return FString::FromInt(Index); }); };
+	TestTrue(FString::Printf(TEXT("Async swing hits the same targets as sync (sync %s, async %s)"), *Describe(SyncHits), *Describe(AsyncHits)), AsyncHits == SyncHits);
+	return true;
+}
+
+#endif
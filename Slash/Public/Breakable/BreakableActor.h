@@ -10,6 +10,8 @@
 // Forward delcarations
 class UGeometryCollectionComponent;
 class UCapsuleComponent;
+class ULootTable;
+class ATreasure;
 
 UCLASS()
 class SLASH_API ABreakableActor : public AActor, public IHitInterface{
@@ -35,13 +37,19 @@ protected:
 	UCapsuleComponent* Capsule;
 
 private:
-	
+	const TArray<TSoftClassPtr<ATreasure>>& GetLootClasses() const;
+	void SpawnTreasure(TSubclassOf<ATreasure> TreasureClass);
+
+	// Shared between breakables, its classes are soft so they load in the background instead of with the level
+	UPROPERTY(EditAnywhere)
+	ULootTable* LootTable = nullptr;
 
-	// Gets pointer to the BP_Treasure rather than using the C++ raw class
+	// Only used without a loot table. Gets pointer to the BP_Treasure rather than using the C++ raw class
 	UPROPERTY(EditAnywhere)
-	TArray<TSubclassOf<class ATreasure>> TreasureClasses;
-	// Foward declaration in type /\
+	TArray<TSoftClassPtr<ATreasure>> TreasureClasses;
 
 	bool bBroken = false;
 
+public:
+	FORCEINLINE UGeometryCollectionComponent* GetGeometryCollection() const { return GeometryCollection; }
 };
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BreakableDebrisSubsystem.generated.h"
+
+// Forward declarations
+class ABreakableActor;
+class FChaosScene;
+class FPhysScene_Chaos;
+
+/**
+* Budgets the fragments shattered breakables leave behind. Once debris has
+* had time to settle, fragments that have slowed down are put to sleep while
+* ones still moving are left alone, it's faded out and removed after a set
+* lifetime, and when the live fragment count goes over the cap the oldest
+* debris is removed first. Materials can fade with a DebrisFade scalar
+* parameter, ones without it just disappear at the end
+*/
+UCLASS()
+class SLASH_API UBreakableDebrisSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual void Deinitialize() override;
+	/* </UTickableWorldSubsystem> */
+
+	void RegisterDebris(ABreakableActor* Breakable);
+
+	bool IsBudgetEnabled() const;
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	/* Sleeps the fragments slower than the thresholds, returns how many are still awake */
+	int32 SleepSlowFragments(ABreakableActor* Breakable);
+	void RemoveDebris(int32 DebrisIndex);
+	static int32 CountFragments(const ABreakableActor* Breakable);
+
+	void OnPhysicsPreTick(FPhysScene_Chaos* PhysScene, float DeltaSeconds);
+	void OnPhysicsPostTick(FChaosScene* PhysScene);
+
+	UPROPERTY()
+	TArray<ABreakableActor*> Debris;
+
+	/* Packed per-debris data, indices match Debris. Kept in break order so the oldest is always first */
+	TArray<double> BreakTimes;
+	TArray<int32> FragmentCounts;
+	TArray<int32> AwakeCounts;
+
+	/* Physics scene tick timing, wall time on the game thread */
+	FDelegateHandle PhysicsPreTickHandle;
+	FDelegateHandle PhysicsPostTickHandle;
+	uint64 PhysicsStartCycles = 0;
+
+public:
+	FORCEINLINE int32 GetNumDebris() const { return Debris.Num(); }
+};
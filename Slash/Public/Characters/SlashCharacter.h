@@ -29,9 +29,9 @@ class SLASH_API ASlashCharacter : public ABaseCharacter, public IPickupInterface
 public:
 
 	ASlashCharacter();
-	virtual void Tick(float DeltaTime) override;
 
 	/* <AActor> */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
 	/* </AActor> */
 
@@ -111,7 +111,6 @@ protected:
 
 private:
 	void InitializeSlashOverlay();
-	void SetHUDHealth();
 
 	/* States */
 	UPROPERTY(VisibleAnywhere)
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+* Runs attacker/defender exchanges through FCombatRules with no world, so
+* balance and CPU cost can be checked without playing. Same seed, same
+* result, so two runs can be compared line for line
+* Usage: slash.Combat.Benchmark [Exchanges] [Seed]
+*/
+struct SLASH_API FCombatBenchmark {
+	struct FResult {
+		int64 Exchanges = 0;
+		int64 EnemyKills = 0;
+		int64 PlayerDeaths = 0;
+		int64 Dodges = 0;
+		int64 EnemyAttacks = 0;
+		int64 LostInterest = 0;
+		double Seconds = 0.0;
+	};
+
+	static FResult Run(int64 NumExchanges, int32 Seed);
+};
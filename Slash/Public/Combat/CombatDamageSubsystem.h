@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatDamageSubsystem.generated.h"
+
+// Forward declarations
+class AWeapon;
+
+struct FCombatDamageEvent {
+	TWeakObjectPtr<AActor> Target;
+	TWeakObjectPtr<AWeapon> Weapon;
+	FVector ImpactPoint = FVector::ZeroVector;
+	float Damage = 0.f;
+	uint32 TargetId = 0;
+	uint32 Sequence = 0;
+};
+
+/**
+* Weapon hits land here instead of being applied inside the overlap or trace
+* that found them. Once a frame they're resolved together in a fixed order
+* (by target, then by when they were queued): each target takes the frame's
+* damage in one TakeDamage call, then gets one hit reaction and one set of
+* fields from the first weapon that hit it
+*/
+UCLASS()
+class SLASH_API UCombatDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	void QueueDamage(AActor* Target, AWeapon* Weapon, float Damage, const FVector& ImpactPoint);
+	bool IsDeferringDamage() const;
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	void ResolveDamage();
+
+	TArray<FCombatDamageEvent> PendingEvents;
+	// Swapped with PendingEvents while resolving, so hits caused by a resolve wait for next frame
+	TArray<FCombatDamageEvent> ResolvingEvents;
+	uint32 NextSequence = 0;
+
+	/* Totals since the world started */
+	int32 NumQueued = 0;
+	int32 NumResolved = 0;
+
+public:
+	FORCEINLINE int32 GetNumQueued() const { return NumQueued; }
+	FORCEINLINE int32 GetNumResolved() const { return NumResolved; }
+};
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatFXSubsystem.generated.h"
+
+// Forward declarations
+class USoundBase;
+class UParticleSystem;
+class UNiagaraSystem;
+class UAudioComponent;
+class UFXSystemComponent;
+
+// Enums
+enum class ECombatFXType : uint8 {
+	ECFX_Sound,
+	ECFX_Particles,
+	ECFX_Niagara,
+	ECFX_MAX
+};
+
+struct FCombatFXRequest {
+	UObject* Asset = nullptr;
+	FVector Location = FVector::ZeroVector;
+	ECombatFXType Type = ECombatFXType::ECFX_Sound;
+};
+
+/**
+* Collects every hit and pickup effect asked for during the frame and spawns
+* them together. Requests for the same asset close to one another collapse
+* into one, each effect type has a per-frame cap and a cap on how many can be
+* playing at once, and everything spawned comes from a pool: the engine's for
+* particles and Niagara, our own for audio. Requests past a cap are counted as dropped
+*/
+UCLASS()
+class SLASH_API UCombatFXSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	void QueueSound(USoundBase* Sound, const FVector& Location);
+	void QueueParticles(UParticleSystem* Particles, const FVector& Location);
+	void QueueNiagara(UNiagaraSystem* System, const FVector& Location);
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	void Queue(UObject* Asset, const FVector& Location, ECombatFXType Type);
+	bool SpawnEffect(const FCombatFXRequest& Request);
+	UAudioComponent* FindFreeAudioComponent() const;
+	void ReleaseFinishedEffects();
+	int32 GetMaxLive(ECombatFXType Type) const;
+	void TrackLiveEffect(UFXSystemComponent* Component, ECombatFXType Type);
+
+	TArray<FCombatFXRequest> PendingRequests;
+	TArray<FCombatFXRequest> AcceptedRequests;
+
+	UPROPERTY()
+	TArray<UAudioComponent*> AudioPool;
+
+	// Particle and Niagara components still playing, handed back to the engine's pool once they finish
+	UPROPERTY()
+	TArray<UFXSystemComponent*> LiveEffects;
+
+	/* Indices match LiveEffects */
+	TArray<ECombatFXType> LiveEffectTypes;
+
+	int32 NumLive[(uint8)ECombatFXType::ECFX_MAX] = {};
+
+	/* Totals since the world started */
+	int32 NumRequested[(uint8)ECombatFXType::ECFX_MAX] = {};
+	int32 NumSpawned[(uint8)ECombatFXType::ECFX_MAX] = {};
+	int32 NumDropped[(uint8)ECombatFXType::ECFX_MAX] = {};
+
+public:
+	FORCEINLINE int32 GetNumRequested(ECombatFXType Type) const { return NumRequested[(uint8)Type]; }
+	FORCEINLINE int32 GetNumSpawned(ECombatFXType Type) const { return NumSpawned[(uint8)Type]; }
+	FORCEINLINE int32 GetNumDropped(ECombatFXType Type) const { return NumDropped[(uint8)Type]; }
+	FORCEINLINE int32 GetNumLive(ECombatFXType Type) const { return NumLive[(uint8)Type]; }
+};
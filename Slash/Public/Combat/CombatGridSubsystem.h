@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatGridSubsystem.generated.h"
+
+/**
+* Uniform spatial hash of the pawns enemies can engage. Entries are only
+* re-bucketed when their pawn crosses into a new cell, and queries only look
+* at the cells overlapping the query radius
+*/
+UCLASS()
+class SLASH_API UCombatGridSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	void RegisterTarget(APawn* Target);
+	void UnregisterTarget(APawn* Target);
+
+	/**
+	* Nearest target within Radius whose direction from Origin is within the
+	* view cone described by Forward and MinCosAngle. Safe to call from worker
+	* threads as long as the grid isn't being updated at the same time
+	*/
+	APawn* FindNearestTargetInView(const FVector& Origin, const FVector& Forward, double Radius, float MinCosAngle) const;
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	struct FGridEntry {
+		TWeakObjectPtr<APawn> Pawn;
+		// Still finds the entry in EntryIndices once the pawn is gone
+		TObjectKey<APawn> Key;
+		FVector Location;
+		FIntPoint Cell;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+	void AddToCell(const FIntPoint& Cell, int32 EntryIndex);
+	void RemoveFromCell(const FIntPoint& Cell, int32 EntryIndex);
+	void RemoveEntry(int32 EntryIndex);
+
+	template<typename FunctionType>
+	void ForEachEntryInRadius(const FVector& Origin, double Radius, FunctionType Function) const;
+
+	TArray<FGridEntry> Entries;
+	// Where each pawn sits in Entries, so registering and unregistering don't search the array
+	TMap<TObjectKey<APawn>, int32> EntryIndices;
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+
+	// Roughly half the enemy sight radius, so a sight query touches at most a 5x5 block
+	static constexpr double CellSize = 2000.0;
+};
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Enums
+enum class ECombatRangeBand : uint8 {
+	ECRB_InsideAttack,
+	ECRB_InsideCombat,
+	ECRB_Outside
+};
+
+/**
+* Classifies how far a batch of attackers are from their combat targets.
+* Positions and radii live in separate contiguous arrays so the classification
+* loop compiles down to straight SIMD with no branches, and each attacker only
+* pays for one squared distance instead of a sqrt per radius check
+*/
+struct SLASH_API FCombatRangeBatch {
+	void SetNum(int32 Num);
+	void SetEntry(int32 Index, const FVector& Location, const FVector& TargetLocation, double AttackRadius, double CombatRadius);
+	void SetEntryNoTarget(int32 Index);
+	void Classify();
+
+	/* Same result as one entry of Classify, for code paths that only have one attacker */
+	static ECombatRangeBand ClassifySingle(const FVector& Location, const FVector& TargetLocation, double AttackRadius, double CombatRadius);
+
+	FORCEINLINE ECombatRangeBand GetBand(int32 Index) const { return Bands[Index]; }
+	FORCEINLINE int32 Num() const { return Bands.Num(); }
+
+private:
+	TArray<double> X;
+	TArray<double> Y;
+	TArray<double> Z;
+	TArray<double> TargetX;
+	TArray<double> TargetY;
+	TArray<double> TargetZ;
+	TArray<double> AttackRadiusSquared;
+	TArray<double> CombatRadiusSquared;
+	TArray<ECombatRangeBand> Bands;
+};
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Combat/CombatRangeBatch.h"
+
+// Forward declarations
+enum class EEnemyState : uint8; // Characters/CharacterTypes.h, kept out of here so this header only needs Core
+
+// Enums
+enum class EEnemyAIDecision : uint8 {
+	EAD_None,
+	EAD_NextPatrolTarget,
+	EAD_LoseInterest,
+	EAD_Chase,
+	EAD_StartAttack
+};
+
+/**
+* Everything the patrol/combat decision needs, copied out of the enemy on the
+* game thread so the decision itself can run on any thread
+*/
+struct FEnemyAIInput {
+	FVector Location = FVector::ZeroVector;
+	FVector CombatTargetLocation = FVector::ZeroVector;
+	FVector PatrolTargetLocation = FVector::ZeroVector;
+	FVector Forward = FVector::ForwardVector;
+	double CombatRadius = 0.0;
+	double AttackRadius = 0.0;
+	double PatrolRadius = 0.0;
+	double SightRadius = 0.0;
+	float PeripheralVisionCosine = 0.f;
+	EEnemyState EnemyState{}; // EES_NoState
+	bool bHasCombatTarget = false;
+	bool bHasPatrolTarget = false;
+	bool bWantsSight = false;
+};
+
+/**
+* The combat rules on their own: health and stamina math plus the enemy
+* state decisions. Nothing in here touches a UObject or a world, so the
+* actors just feed their numbers through it, and the same rules can be run
+* headless by the 'slash.Combat.Benchmark' console command
+*/
+struct SLASH_API FCombatRules {
+	/* Attributes, each returns the new value */
+	static float ApplyDamage(float Health, float MaxHealth, float Damage);
+	static float SpendStamina(float Stamina, float MaxStamina, float StaminaCost);
+	static float RegenStamina(float Stamina, float MaxStamina, float RegenRate, float DeltaTime);
+	static float RegenHealth(float Health, float MaxHealth, float RegenRate, float DeltaTime);
+	// Seconds until a regenerating (or draining) value is full (or empty), negative if it never will be
+	static float TimeToLimit(float Value, float MaxValue, float RegenRate);
+	static bool CanAffordStamina(float Stamina, float StaminaCost);
+	static bool IsAlive(float Health);
+
+	/* Enemy state */
+	// The scalar range check AEnemy's IsInsideAttackRadius and friends are built on, FCombatRangeBatch has to agree with it
+	static bool IsInRange(const FVector& Location, const FVector& TargetLocation, double Radius);
+	static ECombatRangeBand ClassifyCombatRange(const FEnemyAIInput& Input);
+	static EEnemyAIDecision DecideAction(const FEnemyAIInput& Input, ECombatRangeBand CombatRange);
+	static EEnemyAIDecision DecideCombatAction(const FEnemyAIInput& Input, ECombatRangeBand CombatRange);
+	static EEnemyAIDecision DecidePatrolAction(const FEnemyAIInput& Input);
+	static bool CanEnemyAttack(EEnemyState EnemyState, bool bInsideAttackRadius);
+	static EEnemyState EnemyStateWhenDamaged(bool bInsideAttackRadius);
+};
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StatusEffectSubsystem.generated.h"
+
+// Forward declarations
+class UAttributeComponent;
+
+// Enums
+enum class EStatusEffectType : uint8 {
+	ESE_Bleed,
+	ESE_Poison,
+	ESE_Regen,
+	ESE_MAX
+};
+
+/* Every active effect of one type, indices line up across the arrays */
+struct FStatusEffectBucket {
+	TArray<int32> TargetSlots;
+	TArray<float> HealthPerSecond;
+	TArray<float> RemainingTimes;
+
+	void Add(int32 TargetSlot, float InHealthPerSecond, float Duration);
+	void RemoveAtSwap(int32 Index);
+	FORCEINLINE int32 Num() const { return TargetSlots.Num(); }
+};
+
+/**
+* Runs every bleed, poison and regen in the world instead of each one having
+* its own timer. Effects live in flat arrays per type and all advance together
+* at a fixed cadence; their health changes are summed per target and handed to
+* each UAttributeComponent once per update. Effects on the same target stack
+*/
+UCLASS()
+class SLASH_API UStatusEffectSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	/* Magnitude is health per second, always positive, the effect type decides whether it hurts or heals */
+	void ApplyEffect(UAttributeComponent* Target, EStatusEffectType Type, float Magnitude, float Duration);
+	void ClearEffects(UAttributeComponent* Target);
+	int32 GetNumActiveEffects() const;
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	void StepEffects(float StepTime);
+	void ApplyHealthDeltas();
+	void RemoveExpiredEffects();
+	int32 AcquireTargetSlot(UAttributeComponent* Target);
+	void ReleaseTargetSlot(int32 TargetSlot);
+
+	FStatusEffectBucket Buckets[(uint8)EStatusEffectType::ESE_MAX];
+
+	/* Targets, indexed by the slots stored in the buckets */
+	TArray<TWeakObjectPtr<UAttributeComponent>> Targets;
+	TArray<TObjectKey<UAttributeComponent>> TargetKeys;
+	TArray<float> TargetHealthDeltas;
+	TArray<int32> TargetEffectCounts;
+	TArray<int32> FreeTargetSlots;
+	TMap<TObjectKey<UAttributeComponent>, int32> TargetSlotLookup;
+
+	// Time waiting for the next fixed step
+	float StepAccumulator = 0.f;
+
+public:
+	FORCEINLINE int32 GetNumActiveEffects(EStatusEffectType Type) const { return Buckets[(uint8)Type].Num(); }
+};
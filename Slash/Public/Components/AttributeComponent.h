@@ -6,6 +6,21 @@
 #include "Components/ActorComponent.h"
 #include "AttributeComponent.generated.h"
 
+// Enums
+enum class EAttributeType : uint8 {
+	EAT_Health,
+	EAT_Stamina,
+	EAT_Gold,
+	EAT_Souls,
+	EAT_MAX
+};
+
+/**
+* Fired when an attribute is changed by a call on the component, with its old
+* and new value. Regen isn't broadcast as it happens, the Get*LimitTime
+* functions say how long a value will keep changing on its own
+*/
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnAttributeChanged, EAttributeType /* Attribute */, float /* OldValue */, float /* NewValue */);
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class SLASH_API UAttributeComponent : public UActorComponent
@@ -48,17 +63,41 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
 	float StaminaRegenRate = 8.f;
 
+	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
+	float HealthRegenRate = 0.f;
+
+	/*
+	* Regen is worked out when the value is read instead of every tick:
+	* Health/Stamina hold the value as of their timestamp (world seconds)
+	*/
+	double HealthTimestamp = 0.0;
+	double StaminaTimestamp = 0.0;
+
+	double GetNow() const;
+	void SettleHealth();
+	void SettleStamina();
+	double GetLimitTime(float Value, float MaxValue, float RegenRate) const;
+	void BroadcastChange(EAttributeType Attribute, float OldValue, float NewValue);
+
 public:
-	void RegenStamina(float DeltaTime);
+	FOnAttributeChanged OnAttributeChanged;
+
 	void ReceiveDamage(float Damage);
+	// Positive heals, negative hurts, the dead can't be healed
+	void ApplyHealthDelta(float Delta);
 	void UseStamina(float StaminaCost);
+	void ResetAttributes();
+	float GetHealth() const;
+	float GetStamina() const;
 	float GetHealthPercent();
 	float GetStaminaPercent();
 	bool IsAlive();
+	/* World time health/stamina will be full (or empty when draining), negative if it isn't changing */
+	double GetHealthLimitTime() const;
+	double GetStaminaLimitTime() const;
 	void AddSouls(int32 NumOfSouls);
 	void AddGold(int32 AmountOfGold);
 	FORCEINLINE int32 GetGold() const { return Gold; }
 	FORCEINLINE int32 GetSouls() const { return Souls; }
 	FORCEINLINE float GetDodgeCost() const { return DodgeCost; }
-	FORCEINLINE float GetStamina() const { return Stamina; }
 };
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "FactionComponent.generated.h"
+
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EFactionFlags : uint8 {
+	EFF_None = 0 UMETA(Hidden),
+	EFF_Enemy = 1 << 0 UMETA(DisplayName = "Enemy"),
+	EFF_Dead = 1 << 1 UMETA(DisplayName = "Dead"),
+	EFF_Engageable = 1 << 2 UMETA(DisplayName = "Engageable Target")
+};
+ENUM_CLASS_FLAGS(EFactionFlags);
+
+/**
+* Who a character fights for and whether it's still in the fight, as bitflags
+* so the weapon/sensing/attack checks don't have to scan the Tags array.
+* The matching legacy tags (Enemy, Dead, EngageableTarget) are kept on the
+* owner for anything in Blueprints still using ActorHasTag
+*/
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class SLASH_API UFactionComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UFactionComponent();
+
+	void AddFlags(EFactionFlags FlagsToAdd);
+	void RemoveFlags(EFactionFlags FlagsToRemove);
+	bool IsSameTeam(const UFactionComponent* Other) const;
+
+	/* Faction of an actor, null for anything that isn't a character */
+	static UFactionComponent* FindFaction(const AActor* Actor);
+	static bool ActorHasFlags(const AActor* Actor, EFactionFlags FlagsToCheck);
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+private:
+	void ReadLegacyTags();
+	void SyncLegacyTags(EFactionFlags ChangedFlags);
+
+	UPROPERTY(EditAnywhere, Category = "Faction", meta = (Bitmask, BitmaskEnum = "/Script/Slash.EFactionFlags"))
+	uint8 Flags = 0;
+
+public:
+	FORCEINLINE EFactionFlags GetFlags() const { return static_cast<EFactionFlags>(Flags); }
+	FORCEINLINE bool HasAllFlags(EFactionFlags FlagsToCheck) const { return EnumHasAllFlags(GetFlags(), FlagsToCheck); }
+	FORCEINLINE bool HasAnyFlags(EFactionFlags FlagsToCheck) const { return EnumHasAnyFlags(GetFlags(), FlagsToCheck); }
+	FORCEINLINE bool IsDead() const { return HasAnyFlags(EFactionFlags::EFF_Dead); }
+};
@@ -5,12 +5,14 @@
 #include "CoreMinimal.h"
 #include "Characters/BaseCharacter.h"
 #include "Characters/CharacterTypes.h"
+#include "Enemy/EnemyAISubsystem.h"
 #include "Enemy.generated.h"
 
 // Forward delcarations
 class UHealthBarComponent;
 class UPawnSensingComponent;
 class AAIController;
+class APatrolRoute;
 
 
 UCLASS()
@@ -19,11 +21,12 @@ class SLASH_API AEnemy : public ABaseCharacter
 	GENERATED_BODY()
 
 public:
-	AEnemy();
+	AEnemy(const FObjectInitializer& ObjectInitializer);
 	/* <AActor> */
 	virtual void Tick(float DeltaTime) override;
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
 	virtual void Destroyed() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	/* </AActor> */
 
 	/* <IHitInterface> */
@@ -41,7 +44,6 @@ protected:
 	virtual void Attack() override;
 	virtual bool CanAttack() override;
 	virtual void AttackEnd() override;
-	virtual void HandleDamage(float DamageAmount) override;
 	virtual int32 PlayAttackMontage() override;
 	/* <ABaseCharacter> */
 
@@ -59,18 +61,18 @@ private:
 	void LoseInterest();
 	void StartPatrolling();
 	void ChaseTarget();
-	bool IsOutsideCombatRadius();
-	bool IsOutsideAttackRadius();
 	bool IsInsideAttackRadius();
-	bool IsChasing();
-	bool IsAttacking();
 	bool IsDead();
 	bool IsEngaged();
+	void RegisterWithAI();
 	void StartAttackTimer();
 	void ClearAttackTimer();
 	bool InTargetRange(AActor* Target, double Radius);
 	void MoveToTarget(AActor* Target);
-	AActor* ChoosePatrolTarget();
+	void MoveToLocation(const FVector& Location);
+	void RequestMove(AActor* GoalActor, const FVector& GoalLocation);
+	void MoveToPatrolTarget();
+	void ChoosePatrolTarget();
 	void SpawnDefaultWeapon();
 	UFUNCTION()
 	void PawnSeen(APawn* SeenPawn); // Callback for OnPawnSeen in UPawnSensingComponent
@@ -82,6 +84,13 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	UPawnSensingComponent* PawnSensing;
 
+	// Set when the combat grid does our sight checks instead of PawnSensing
+	bool bUseGridSensing = false;
+	double NextSightTime = 0.0;
+
+	// Forces a full rate AI update next frame regardless of AI LOD
+	bool bAIPromoted = false;
+
 	/* 
 	* Combat 
 	*/
@@ -122,6 +131,13 @@ private:
 	*/
 	FTimerHandle PatrolTimer;
 
+	// Shared waypoint graph, used instead of PatrolTarget/PatrolTargets when set
+	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
+	APatrolRoute* PatrolRoute;
+
+	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
+	int32 PatrolWaypoint = 0;
+
 	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
 	AActor* PatrolTarget;
 
@@ -139,4 +155,17 @@ private:
 	UPROPERTY(EditAnywhere, Category = Combat)
 	float PatrollingSpeed = 125.f;
 
+public:
+	/* Batched AI, driven by UEnemyAISubsystem */
+	void GatherAIInput(FEnemyAIInput& OutInput) const;
+	void ExecuteAIDecision(EEnemyAIDecision Decision);
+	void SenseTarget(APawn* SeenPawn);
+	bool ConsumeAIPromotion();
+	FORCEINLINE EEnemyState GetEnemyState() const { return EnemyState; }
+	FORCEINLINE AAIController* GetEnemyController() const { return EnemyController; }
+
+	/* Pooling, driven by UEnemyPoolSubsystem */
+	void DeactivateToPool();
+	void ReactivateFromPool(const FTransform& SpawnTransform, APatrolRoute* NewPatrolRoute);
+	void SetPatrolRoute(APatrolRoute* NewPatrolRoute);
 };
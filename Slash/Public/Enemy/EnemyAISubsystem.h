@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Characters/CharacterTypes.h"
+#include "Combat/CombatRules.h"
+#include "EnemyAISubsystem.generated.h"
+
+// Forward declarations
+class AEnemy;
+class UCombatGridSubsystem;
+
+// Enums
+// How often an enemy's AI gets re-evaluated, based on distance to the nearest player
+enum class EEnemyAILOD : uint8 {
+	EAL_Near,
+	EAL_Mid,
+	EAL_Far,
+	EAL_MAX
+};
+
+/**
+* Owns every live enemy in the world and runs their AI decisions in one batched
+* pass instead of each enemy ticking on its own
+*/
+UCLASS()
+class SLASH_API UEnemyAISubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	void RegisterEnemy(AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	void GatherInputs();
+	void EvaluateDecisions();
+	void ApplyDecisions();
+	void RemoveEnemyAt(int32 Index);
+	void GatherPlayerLocations();
+	EEnemyAILOD ComputeLOD(const AEnemy* Enemy) const;
+	bool ShouldUpdateThisFrame(EEnemyAILOD LOD, uint32 StaggerOffset) const;
+
+	UPROPERTY()
+	TArray<AEnemy*> Enemies;
+
+	// Where each enemy sits in Enemies, so registering and unregistering don't search the array. Keys are only compared
+	TMap<AEnemy*, int32> EnemyIndices;
+
+	// Set while decisions run, enemies unregistered then are only nulled out and removed once the loop is done
+	bool bApplyingDecisions = false;
+	bool bHasDeferredRemovals = false;
+
+	/* Packed per-enemy data, indices match Enemies */
+	TArray<uint32> StaggerOffsets;
+	TArray<bool> UpdateThisFrame;
+	TArray<FEnemyAIInput> Inputs;
+	FCombatRangeBatch CombatRanges;
+	TArray<EEnemyAIDecision> Decisions;
+
+	// Cleared every frame, only holds what this frame's sight checks found. Indices match Enemies
+	UPROPERTY()
+	TArray<APawn*> SeenTargets;
+
+	UPROPERTY()
+	UCombatGridSubsystem* CombatGrid;
+
+	/* AI LOD */
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+	uint32 FrameCounter = 0;
+	uint32 NextStaggerOffset = 0;
+	int32 NumEnemiesPerLOD[(uint8)EEnemyAILOD::EAL_MAX] = {};
+
+	// Below this many enemies the pass isn't worth spreading across worker threads
+	static constexpr int32 MinEnemiesForParallel = 64;
+
+public:
+	FORCEINLINE int32 GetNumEnemies() const { return Enemies.Num(); }
+	FORCEINLINE int32 GetNumEnemiesInLOD(EEnemyAILOD LOD) const { return NumEnemiesPerLOD[(uint8)LOD]; }
+};
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyBenchmarkSubsystem.generated.h"
+
+// Forward declarations
+class AEnemy;
+class APatrolRoute;
+
+/* One enemy count's worth of results, times are game thread milliseconds summed over the recorded frames */
+struct FEnemyBenchmarkRun {
+	int32 NumEnemies = 0;
+	int32 NumSpawned = 0;
+	int32 Frames = 0;
+	double SimulatedSeconds = 0.0;
+	double FrameMs = 0.0;
+	double MaxFrameMs = 0.0;
+	double AIMs = 0.0;
+	double MoveSchedulerMs = 0.0;
+	double MovementMs = 0.0;
+	double CombatMs = 0.0;
+	// Most enemies chasing, attacking or engaged on any one frame, zero means nobody noticed the target
+	int32 MaxEnemiesInCombat = 0;
+	bool bTargetSurvived = true;
+};
+
+/**
+* Measures how the game scales with enemy count. For each count it spawns
+* that many enemies on a grid with their own patrol routes, drags the player
+* pawn through them on a fixed loop, runs a fixed number of simulated seconds
+* at a fixed time step and writes the per frame AI, move scheduler, character
+* movement and combat time to a CSV under Saved/Profiling/Slash. Works
+* headless with -nullrhi
+* Usage: slash.Benchmark.EnemyScaling [Counts] [Seconds] [EnemyClass]
+*/
+UCLASS()
+class SLASH_API UEnemyBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual void Deinitialize() override;
+	/* </UTickableWorldSubsystem> */
+
+	/* Target defaults to the player pawn. It's made an engageable combat grid target so enemies go after it */
+	bool StartBenchmark(TSubclassOf<AEnemy> InEnemyClass, const TArray<int32>& InEnemyCounts, float InSeconds, APawn* InTarget = nullptr);
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	void StartRun();
+	void RecordFrame(float DeltaTime);
+	void FinishRun();
+	void FinishBenchmark();
+	void SpawnEnemies(int32 NumEnemies);
+	void DestroyEnemies();
+	void MoveTarget();
+	void WriteResults() const;
+
+	UPROPERTY()
+	TArray<AEnemy*> SpawnedEnemies;
+
+	UPROPERTY()
+	TArray<APatrolRoute*> SpawnedRoutes;
+
+	UPROPERTY()
+	TSubclassOf<AEnemy> EnemyClass;
+
+	TWeakObjectPtr<APawn> Target;
+	FVector Origin = FVector::ZeroVector;
+	double FieldRadius = 0.0;
+
+	TArray<int32> EnemyCounts;
+	TArray<FEnemyBenchmarkRun> Results;
+	FEnemyBenchmarkRun CurrentRun;
+	int32 RunIndex = INDEX_NONE;
+	int32 WarmupFramesLeft = 0;
+	int32 RecordFramesLeft = 0;
+	int32 FrameNumber = 0;
+	double LastFrameTime = 0.0;
+	float Seconds = 0.f;
+
+	// Restored when the benchmark is done
+	bool bSavedUseFixedTimeStep = false;
+	double SavedFixedDeltaTime = 0.0;
+
+public:
+	FORCEINLINE bool IsRunning() const { return RunIndex != INDEX_NONE; }
+	FORCEINLINE const TArray<FEnemyBenchmarkRun>& GetResults() const { return Results; }
+};
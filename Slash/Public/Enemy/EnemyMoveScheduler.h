@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AITypes.h"
+#include "NavigationSystemTypes.h"
+#include "EnemyMoveScheduler.generated.h"
+
+// Forward declarations
+class AEnemy;
+
+// Enums
+enum class EEnemyMoveUrgency : uint8 {
+	EMU_Patrol,
+	EMU_Chase
+};
+
+struct FEnemyMoveRequest {
+	TWeakObjectPtr<AEnemy> Enemy;
+	TWeakObjectPtr<AActor> GoalActor;
+	FVector GoalLocation = FVector::ZeroVector;
+	float AcceptanceRadius = 0.f;
+	EEnemyMoveUrgency Urgency = EEnemyMoveUrgency::EMU_Patrol;
+	double DistSquaredToGoal = 0.0;
+	double RequestTime = 0.0;
+
+	bool IsMoveToActor() const { return !GoalActor.IsExplicitlyNull(); }
+	bool IsSameGoal(const FEnemyMoveRequest& Other) const;
+	FAIMoveRequest ToAIMoveRequest() const;
+};
+
+/**
+* Sits in front of AEnemy's MoveTo calls so a whole group spotting the player
+* on the same frame doesn't turn into a burst of pathfinding. Requests for a
+* goal an enemy is already heading to are dropped, the rest are queued by
+* urgency and distance and only a capped number of path queries go out each
+* frame, asynchronously when there's a navigation system to ask
+*/
+UCLASS()
+class SLASH_API UEnemyMoveScheduler : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	void RequestMove(AEnemy* Enemy, AActor* GoalActor, const FVector& GoalLocation, float AcceptanceRadius, EEnemyMoveUrgency Urgency);
+	void CancelMoves(AEnemy* Enemy);
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	bool IssueMove(const FEnemyMoveRequest& Request);
+	void OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+	bool IsAlreadyMovingTo(AEnemy* Enemy, const FEnemyMoveRequest& Request) const;
+	// Seconds from RequestMove to the enemy actually setting off
+	void RecordLatency(double Latency);
+	void RemovePendingMove(int32 Index);
+	void RebuildPendingIndices();
+
+	TArray<FEnemyMoveRequest> PendingMoves;
+	TMap<uint32, FEnemyMoveRequest> InFlightMoves;
+	// Per enemy lookups into the two above, so a request doesn't scan either
+	TMap<TObjectKey<AEnemy>, int32> PendingIndices;
+	TMap<TObjectKey<AEnemy>, uint32> InFlightQueryIDs;
+	TMap<TObjectKey<AEnemy>, FEnemyMoveRequest> IssuedMoves;
+
+	/* Counters */
+	int32 NumCoalescedThisFrame = 0;
+	int32 NumIssuedThisFrame = 0;
+	double AverageLatency = 0.0;
+
+public:
+	FORCEINLINE int32 GetQueueDepth() const { return PendingMoves.Num() + InFlightMoves.Num(); }
+	FORCEINLINE double GetAverageLatency() const { return AverageLatency; }
+};
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "EnemyMovementComponent.generated.h"
+
+/**
+* Enemy character movement. Behaves exactly like the stock component, it's
+* only here so the enemy scaling benchmark can charge the movement tick to
+* its own bucket
+*/
+UCLASS()
+class SLASH_API UEnemyMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	/* <UActorComponent> */
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	/* </UActorComponent> */
+};
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyPoolSubsystem.generated.h"
+
+// Forward declarations
+class AEnemy;
+class APatrolRoute;
+
+USTRUCT()
+struct FEnemyPoolBucket {
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AEnemy*> Enemies;
+};
+
+USTRUCT()
+struct FEnemyCorpse {
+	GENERATED_BODY()
+
+	UPROPERTY()
+	AEnemy* Enemy = nullptr;
+
+	double ExpireTime = 0.0;
+};
+
+/**
+* Recycles dead enemies, along with the weapon they spawned with, instead of
+* destroying them and spawning fresh ones for the next wave. Corpses stay
+* visible for their DeathLifeSpan, or until the corpse cap pushes the oldest
+* one out, then get parked hidden until a spawn asks for their class again
+*/
+UCLASS()
+class SLASH_API UEnemyPoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	/* Reuses a pooled enemy of EnemyClass if there is one, otherwise spawns a new one */
+	AEnemy* SpawnEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& SpawnTransform, APatrolRoute* PatrolRoute = nullptr);
+
+	/* Called by a dying enemy in place of SetLifeSpan */
+	void AddCorpse(AEnemy* Enemy, float LifeSpan);
+
+	bool IsPoolingEnabled() const;
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	void ReleaseCorpse(int32 CorpseIndex);
+
+	UPROPERTY()
+	TMap<UClass*, FEnemyPoolBucket> PooledEnemies;
+
+	// Oldest first
+	UPROPERTY()
+	TArray<FEnemyCorpse> Corpses;
+
+	/* Counters */
+	int32 NumReused = 0;
+	int32 NumSpawned = 0;
+
+public:
+	FORCEINLINE int32 GetNumReused() const { return NumReused; }
+	FORCEINLINE int32 GetNumSpawned() const { return NumSpawned; }
+};
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PatrolRoute.generated.h"
+
+/**
+* A whole patrol route in one placed actor. Waypoints are plain positions
+* instead of one actor each, and the adjacency between them is flattened into
+* two arrays up front, so any number of enemies can share a route and pick
+* their next waypoint without allocating
+*/
+UCLASS()
+class SLASH_API APatrolRoute : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	APatrolRoute();
+
+	/* <AActor> */
+	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void PostInitializeComponents() override;
+	/* </AActor> */
+
+	int32 ChooseNextWaypoint(int32 CurrentWaypoint) const;
+	int32 FindNearestWaypoint(const FVector& Location) const;
+	FVector GetWaypointLocation(int32 Waypoint) const;
+	/* For routes built at runtime, positions are relative to the route */
+	void SetWaypoints(const TArray<FVector>& InWaypoints, const TArray<FIntPoint>& InLinks);
+
+private:
+	void BuildAdjacency();
+
+	// Relative to the route, drag them around in the viewport
+	UPROPERTY(EditAnywhere, Category = "AI Navigation", meta = (MakeEditWidget = "true"))
+	TArray<FVector> Waypoints;
+
+	// Two way links between waypoint indices, leave empty to walk the waypoints as a loop in order
+	UPROPERTY(EditAnywhere, Category = "AI Navigation")
+	TArray<FIntPoint> Links;
+
+	/* Neighbours of waypoint i are Adjacency[AdjacencyOffsets[i]] up to Adjacency[AdjacencyOffsets[i + 1]] */
+	TArray<int32> AdjacencyOffsets;
+	TArray<int32> Adjacency;
+
+public:
+	FORCEINLINE int32 GetNumWaypoints() const { return Waypoints.Num(); }
+};
@@ -4,20 +4,38 @@
 
 #include "CoreMinimal.h"
 #include "Components/WidgetComponent.h"
+#include "Components/AttributeComponent.h"
 #include "HealthBarComponent.generated.h"
 
 /**
- * 
- */
+* Enemy health bar. Follows the owner's health change events and redraws at
+* most once per frame, only when the bar would actually move
+*/
 UCLASS()
 class SLASH_API UHealthBarComponent : public UWidgetComponent
 {
 	GENERATED_BODY()
 	
 public:
+	/* <UActorComponent> */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	/* </UActorComponent> */
+
+	void BindAttributes(UAttributeComponent* InAttributes);
 	void SetHealthPercent(float Percent);
 
 private:
+	void OnAttributeChanged(EAttributeType Attribute, float OldValue, float NewValue);
+	void MarkHealthDirty();
+
 	UPROPERTY()
 	class UHealthBar* HealthBarWidget;
+
+	TWeakObjectPtr<UAttributeComponent> Attributes;
+	FDelegateHandle AttributeChangedHandle;
+	bool bHealthDirty = false;
+	// Negative when health isn't regenerating
+	double HealthRegenEndTime = -1.0;
+	float DisplayedHealthPercent = -1.f;
 };
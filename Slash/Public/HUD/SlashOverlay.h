@@ -4,22 +4,51 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "Components/AttributeComponent.h"
 #include "SlashOverlay.generated.h"
 
 /**
- * 
- */
+* Player HUD. Once bound to the player's attributes it follows their change
+* events, and applies whatever changed at most once per frame, skipping
+* anything that would look the same on screen
+*/
 UCLASS()
 class SLASH_API USlashOverlay : public UUserWidget
 {
 	GENERATED_BODY()
 public:
+	void BindAttributes(UAttributeComponent* InAttributes);
 	void SetHealthBarPercent(float Percent);
 	void SetStaminaBarPercent(float Percent);
 	void SetGold(int32 Gold);
 	void SetSouls(int32 Souls);
 
+protected:
+	/* <UUserWidget> */
+	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+	virtual void NativeDestruct() override;
+	/* </UUserWidget> */
+
 private: 
+	void OnAttributeChanged(EAttributeType Attribute, float OldValue, float NewValue);
+	void MarkDirty(EAttributeType Attribute);
+	void RefreshDirtyAttributes();
+
+	TWeakObjectPtr<UAttributeComponent> Attributes;
+	FDelegateHandle AttributeChangedHandle;
+
+	// One bit per EAttributeType waiting to be shown
+	uint8 DirtyAttributes = 0;
+	// Keep refreshing the bars until regen finishes, negative when not regenerating
+	double HealthRegenEndTime = -1.0;
+	double StaminaRegenEndTime = -1.0;
+
+	/* What's on screen right now */
+	float DisplayedHealthPercent = -1.f;
+	float DisplayedStaminaPercent = -1.f;
+	int32 DisplayedGold = -1;
+	int32 DisplayedSouls = -1;
+
 	UPROPERTY(meta = (BindWidget))
 	class UProgressBar* HealthProgressBar;
 
@@ -25,13 +25,31 @@ public:
 	// Sets default values for this actor's properties
 	AItem();
 
-	// Called every frame
+	// Only ticks when UItemHoverSubsystem isn't animating the hover, or for subclasses that turn it on
 	virtual void Tick(float DeltaTime) override;
 
+	/* Pooling, driven by UPickupPoolSubsystem */
+	void ActivatePickup(const FVector& Location, const FRotator& Rotation);
+	void DeactivatePickup();
+
+	// Souls and treasure collect themselves when an interactor comes in range, returns true if this did
+	virtual bool TryAutoPickup(AActor* Interactor);
+
+	// What the pickup is worth (souls, gold), so ULootRegistrySubsystem can keep it without the actor
+	virtual int32 GetLootValue() const;
+	virtual void SetLootValue(int32 Value);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	void StartHovering();
+	void StopHovering();
+
+	// In range checks go through UPickupProximitySubsystem, or the overlap sphere when there isn't one
+	void EnablePickup();
+	void DisablePickup();
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sine Parameters");
 	float Amplitude = 0.25f;
@@ -58,6 +76,9 @@ protected:
 
 	virtual void SpawnPickupSound();
 
+	// Hands the pickup back to the pool, or destroys it when there's no pool
+	void ConsumePickup();
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly);
 	UStaticMeshComponent* ItemMesh;
 
@@ -76,8 +97,15 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"));
 	float RunningTime;
 
+	// Where the hover started, the bob and spin are worked out from here
+	FVector HoverBaseLocation = FVector::ZeroVector;
+	FQuat HoverBaseRotation = FQuat::Identity;
+
 	UPROPERTY(EditAnywhere)
 	class UNiagaraSystem* PickupEffect;
+
+public:
+	FORCEINLINE UStaticMeshComponent* GetItemMesh() const { return ItemMesh; }
 };
 
 template<typename T>
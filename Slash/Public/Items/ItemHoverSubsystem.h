@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemHoverSubsystem.generated.h"
+
+// Forward declarations
+class AItem;
+
+/**
+* Bobs and spins every hovering pickup in one pass instead of each item
+* ticking on its own. The hover is worked out from the time since the item
+* started hovering rather than added up frame by frame, and written straight
+* to the root's transform without physics or overlap updates, the pickup
+* sphere is big enough that a few cm of bob never changes who's standing in it
+*/
+UCLASS()
+class SLASH_API UItemHoverSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	void RegisterItem(AItem* Item, float Amplitude, float TimeConstant);
+	void UnregisterItem(AItem* Item);
+
+	bool IsBatchingEnabled() const;
+
+	/* Same bob the old per frame AddActorWorldOffset gave at 60fps, minus the frame rate dependence */
+	static float GetHoverHeight(float Amplitude, float TimeConstant, float HoverTime);
+	static float GetHoverYaw(float HoverTime);
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	UPROPERTY()
+	TArray<AItem*> Items;
+
+	/* Packed per-item data, indices match Items */
+	TArray<FVector> BaseLocations;
+	TArray<FQuat> BaseRotations;
+	TArray<float> Amplitudes;
+	TArray<float> TimeConstants;
+	TArray<double> StartTimes;
+
+	// Where each item sits in Items, so registering and unregistering don't search the array. Keys are only compared
+	TMap<AItem*, int32> ItemIndices;
+
+public:
+	FORCEINLINE int32 GetNumItems() const { return Items.Num(); }
+};
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LootBenchmarkSubsystem.generated.h"
+
+// Forward declarations
+class AItem;
+
+/* One pass of the loot load test, frame times are game thread milliseconds summed over the recorded frames */
+struct FLootBenchmarkRun {
+	bool bProxies = false;
+	int32 Frames = 0;
+	double FrameMs = 0.0;
+	double MaxFrameMs = 0.0;
+	// What the loot itself holds, the registry's entries and instances or the pickup actors and their components
+	int64 LootBytes = 0;
+	// Whole process change over the pass, allocator slack and anything else that ran is in there too
+	int64 ProcessBytes = 0;
+};
+
+/**
+* Load test for ULootRegistrySubsystem. Drops the same loot twice in a ring
+* outside the materialize distance around the player, once through the
+* registry so it stays instanced and once as pooled pickup actors, and logs
+* the average frame time and the memory the loot holds in each pass
+* Usage: slash.Benchmark.Loot [Drops] [ItemClass]
+*/
+UCLASS()
+class SLASH_API ULootBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	bool StartBenchmark(TSubclassOf<AItem> InLootClass, int32 InNumDrops);
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	void StartRun(bool bProxies);
+	void FinishRun();
+	void FinishBenchmark();
+	void DropLoot(bool bProxies);
+
+	UPROPERTY()
+	TSubclassOf<AItem> LootClass;
+
+	int32 NumDrops = 0;
+	FVector Origin = FVector::ZeroVector;
+
+	TArray<FLootBenchmarkRun> Runs;
+	int32 WarmupFramesLeft = 0;
+	int32 FramesLeft = 0;
+	double LastFrameSeconds = 0.0;
+	uint64 MemoryBefore = 0;
+
+	// The actor pass's pickups, destroyed rather than pooled once it's done
+	UPROPERTY()
+	TArray<AItem*> SpawnedLoot;
+
+public:
+	FORCEINLINE bool IsRunning() const { return Runs.Num() > 0; }
+};
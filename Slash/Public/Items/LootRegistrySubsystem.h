@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LootRegistrySubsystem.generated.h"
+
+// Forward declarations
+class AItem;
+class UInstancedStaticMeshComponent;
+
+USTRUCT()
+struct FLootProxyBucket {
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UInstancedStaticMeshComponent* Instances = nullptr;
+
+	// The class default's mesh transform, a spawned pickup's root ends up with it on top of the drop transform
+	FTransform MeshTransform = FTransform::Identity;
+
+	// Instances hidden when their loot materialized, reused before adding new ones
+	TArray<int32> FreeInstances;
+};
+
+/**
+* Keeps dropped souls and treasure that no player is near as plain entries,
+* a class, a transform and a value, drawn with one instanced static mesh per
+* loot class instead of an actor with a mesh, sphere and Niagara component
+* each. Once a player gets within the materialize distance the entry becomes
+* a real pickup out of UPickupPoolSubsystem, and pickups everyone has walked
+* away from go back to being entries. Entries sit in a uniform grid, so a
+* player only checks the ones in nearby cells. Proxies don't get the item's embers
+*/
+UCLASS()
+class SLASH_API ULootRegistrySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	/* Drops a pickup, or just an entry when no player is near. INDEX_NONE keeps the class default's value. Returns the pickup if one was spawned */
+	AItem* DropLoot(TSubclassOf<AItem> ItemClass, const FTransform& Transform, int32 Value = INDEX_NONE);
+
+	// Stops tracking a pickup that's been collected or pooled
+	void ForgetLoot(AItem* Item);
+
+	// Drops every entry without spawning anything, for load tests
+	void ClearProxies();
+
+	bool IsRegistryEnabled() const;
+	double GetMaterializeDistance() const;
+
+	// Bytes held for the entries, the packed arrays, the grid and the instanced meshes' instance data
+	SIZE_T GetProxyAllocatedSize() const;
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	void UpdatePlayerLocations();
+	bool IsNearPlayer(const FVector& Location, double DistanceSquared) const;
+	void GatherProxiesNearPlayers(double Distance, TArray<int32>& OutProxyIndices) const;
+	void AddProxy(UClass* ItemClass, const FTransform& Transform, int32 Value);
+	void RemoveProxy(int32 ProxyIndex);
+	AItem* SpawnLoot(UClass* ItemClass, const FTransform& Transform, int32 Value);
+	void TrackLoot(AItem* Item, const FTransform& Transform);
+	FLootProxyBucket& FindOrAddBucket(UClass* ItemClass);
+	FIntPoint GetCell(const FVector& Location) const;
+	void RemoveFromCell(const FIntPoint& Cell, int32 ProxyIndex);
+
+	UPROPERTY()
+	TArray<UClass*> ProxyClasses;
+
+	/* Packed per-proxy data, indices match ProxyClasses */
+	TArray<FTransform> ProxyTransforms;
+	TArray<int32> ProxyValues;
+	TArray<int32> ProxyInstances;
+	TArray<FIntPoint> ProxyCells;
+
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+
+	UPROPERTY()
+	TArray<AItem*> LiveLoot;
+
+	/* Indices match LiveLoot. Where the pickup was dropped, the actor itself is off bobbing */
+	TArray<FTransform> LiveLootTransforms;
+
+	UPROPERTY()
+	TMap<UClass*, FLootProxyBucket> Buckets;
+
+	// Owns the instanced mesh components
+	UPROPERTY()
+	AActor* ProxyActor = nullptr;
+
+	TArray<FVector> PlayerLocations;
+
+	// The default materialize distance, so a player's query touches a 3x3 block
+	static constexpr double CellSize = 2500.0;
+
+public:
+	FORCEINLINE int32 GetNumProxies() const { return ProxyClasses.Num(); }
+	FORCEINLINE int32 GetNumLiveLoot() const { return LiveLoot.Num(); }
+};
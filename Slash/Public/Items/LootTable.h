@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "LootTable.generated.h"
+
+// Forward declarations
+class ATreasure;
+
+/**
+* Treasure a group of breakables can drop. The classes are soft references,
+* so placing a breakable doesn't drag every treasure Blueprint's meshes,
+* sounds and effects in with the level. ULootTableSubsystem loads them in
+* the background once the breakable begins play
+*/
+UCLASS(BlueprintType)
+class SLASH_API ULootTable : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Loot")
+	TArray<TSoftClassPtr<ATreasure>> TreasureClasses;
+};
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "LootTableSubsystem.generated.h"
+
+// Forward declarations
+class ATreasure;
+
+/**
+* Loads soft referenced loot classes in the background and keeps them
+* resident for the rest of the world, topping up UPickupPoolSubsystem with a
+* few hidden pickups of each once they're in. Drops only ever pick from
+* classes that are already loaded, nothing here blocks on a load
+*/
+UCLASS()
+class SLASH_API ULootTableSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/* Starts loading whatever isn't resident yet, OnLoaded fires once all of it is (straight away if it already is) */
+	void LoadLoot(const TArray<TSoftClassPtr<ATreasure>>& TreasureClasses, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	/* A random class out of the ones already loaded, null if none of them are yet */
+	TSubclassOf<ATreasure> PickResidentTreasure(const TArray<TSoftClassPtr<ATreasure>>& TreasureClasses) const;
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	void PrewarmLoot(TArray<FSoftObjectPath> LoadedPaths);
+
+	// Holding the handles is what keeps the classes loaded
+	TArray<TSharedPtr<FStreamableHandle>> LoadHandles;
+
+	// Already requested, so breakables sharing a table don't queue the same load again
+	TSet<FSoftObjectPath> RequestedPaths;
+
+public:
+	FORCEINLINE int32 GetNumRequested() const { return RequestedPaths.Num(); }
+};
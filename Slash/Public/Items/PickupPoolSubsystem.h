@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PickupPoolSubsystem.generated.h"
+
+// Forward declarations
+class AItem;
+
+USTRUCT()
+struct FPickupPoolBucket {
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AItem*> Items;
+};
+
+/**
+* Keeps picked up souls and treasure around hidden instead of destroying them,
+* so the next drop of the same class reuses one rather than spawning a new
+* mesh, overlap sphere and Niagara component. Grows as pickups are released,
+* up to a fixed number per class
+*/
+UCLASS()
+class SLASH_API UPickupPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	AItem* SpawnPickup(TSubclassOf<AItem> ItemClass, const FVector& Location, const FRotator& Rotation);
+
+	template<typename T>
+	T* SpawnPickup(TSubclassOf<T> ItemClass, const FVector& Location, const FRotator& Rotation);
+
+	/* Hides the pickup and keeps it for reuse, or destroys it if the pool is full */
+	void ReleasePickup(AItem* Item);
+
+	/* Tops the class's pool up to Count hidden pickups, so the first drops reuse rather than spawn */
+	void PrewarmPickups(TSubclassOf<AItem> ItemClass, int32 Count);
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	UPROPERTY()
+	TMap<UClass*, FPickupPoolBucket> PooledPickups;
+
+	/* Counters */
+	int32 NumReused = 0;
+	int32 NumSpawned = 0;
+
+public:
+	FORCEINLINE int32 GetNumReused() const { return NumReused; }
+	FORCEINLINE int32 GetNumSpawned() const { return NumSpawned; }
+};
+
+template<typename T>
+inline T* UPickupPoolSubsystem::SpawnPickup(TSubclassOf<T> ItemClass, const FVector& Location, const FRotator& Rotation) {
+	return Cast<T>(SpawnPickup(TSubclassOf<AItem>(ItemClass.Get()), Location, Rotation));
+}
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PickupProximitySubsystem.generated.h"
+
+// Forward declarations
+class AItem;
+
+/**
+* Finds the pickups each player is standing near without an overlap sphere
+* per item. Pickups sit in a uniform grid while they're on the ground, and
+* once a frame every player pawn asks the grid for what's in range. Souls and
+* treasure collect themselves, and the nearest other item in range becomes
+* the player's overlapping item
+*/
+UCLASS()
+class SLASH_API UPickupProximitySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/* <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/* </UTickableWorldSubsystem> */
+
+	void RegisterItem(AItem* Item, float Radius);
+	void UnregisterItem(AItem* Item);
+
+	bool IsProximityEnabled() const;
+
+protected:
+	/* <UWorldSubsystem> */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/* </UWorldSubsystem> */
+
+private:
+	struct FInteractorState {
+		TWeakObjectPtr<APawn> Pawn;
+		TWeakObjectPtr<AItem> NearestItem;
+	};
+
+	void UpdateInteractor(APawn* Pawn);
+	void SetNearestItem(APawn* Pawn, AItem* NearestItem);
+	FIntPoint GetCell(const FVector& Location) const;
+	void RemoveFromCell(const FIntPoint& Cell, int32 ItemIndex);
+
+	UPROPERTY()
+	TArray<AItem*> Items;
+
+	/* Packed per-item data, indices match Items. Pickups don't move while they're registered */
+	TArray<FVector> Locations;
+	TArray<float> Radii;
+	TArray<FIntPoint> ItemCells;
+
+	// Where each item sits in Items, so registering and unregistering don't search the array. Keys are only compared
+	TMap<AItem*, int32> ItemIndices;
+
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+	TArray<FInteractorState> Interactors;
+
+	// Largest pickup radius registered, how far out a player's query has to reach
+	float MaxRadius = 0.f;
+
+	// About twice the default pickup radius, so a query touches at most a 2x2 block
+	static constexpr double CellSize = 600.0;
+};
@@ -14,8 +14,12 @@ class SLASH_API ASoul : public AItem
 {
 	GENERATED_BODY()
 
+public:
+	virtual int32 GetLootValue() const override;
+	virtual void SetLootValue(int32 Value) override;
+
 protected:
-	virtual void OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) override;
+	virtual bool TryAutoPickup(AActor* Interactor) override;
 private:
 	UPROPERTY(EditAnywhere, Category = "Soul Properties")
 	int32 Souls;
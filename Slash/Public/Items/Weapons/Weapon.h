@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Items/Item.h"
+#include "Items/Weapons/WeaponHitSet.h"
+#include "WorldCollision.h"
 #include "Weapon.generated.h"
 
 class USoundBase;
@@ -18,12 +20,15 @@ class SLASH_API AWeapon : public AItem
 	GENERATED_BODY()
 public:
 	AWeapon();
+	virtual void Tick(float DeltaTime) override;
 	void Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOwner, APawn* NewInstigator);
 	void DeactivateEmbers();
-	void DisableSphereCollision();
 	void PlayEquipSound();
 	void AttachMeshToSocket(USceneComponent* InParent, const FName& InSocketName);
-	TArray<AActor*> IgnoreActors;
+	// Called when weapon collision is switched on/off for an attack
+	void SetSwingActive(bool bActive);
+	// Damage, hit reaction and fields for one target, straight away or from UCombatDamageSubsystem
+	void ResolveHit(AActor* Target, float HitDamage, const FVector& ImpactPoint);
 protected:
 	virtual void BeginPlay() override;
 
@@ -32,12 +37,30 @@ protected:
 
 	bool ActorIsSameType(AActor* OtherActor);
 
-	void ExecuteGetHit(FHitResult& BoxHit);
+	void ExecuteGetHit(AActor* Target, const FVector& ImpactPoint);
+	void HandleWeaponHit(FHitResult& BoxHit);
 
 	UFUNCTION(BlueprintImplementableEvent)
 	void CreateFields(const FVector& FieldLocation);
 private:
 	void BoxTrace(FHitResult& BoxHit);
+	bool IsSweepingSwing() const;
+	void SweepSwing();
+	void SweepBlade(const FVector& FromCenter, const FVector& ToCenter, const FQuat& Rotation, const FVector& HalfSize);
+	bool IsAsyncTracing() const;
+	void SubmitAsyncTrace(EAsyncTraceType TraceType, const FVector& Start, const FVector& End, const FQuat& Rotation, const FCollisionShape& Shape);
+	void OnAsyncTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+	/* Handles a sweep's new hits, true when a target blocked it and it should go again past them */
+	bool HandleSweepHits(TArrayView<FHitResult> Hits);
+	static bool IsSwingTarget(const AActor* Actor);
+	void DrawTraceDebug(const FVector& Start, const FVector& End, const FQuat& Rotation, const FVector& HalfSize, bool bHit) const;
+
+	// Actors already hit this swing, reset when the next swing starts
+	FWeaponHitSet HitSet;
+
+	// Async trace results from an earlier swing are thrown away
+	uint32 SwingId = 0;
+	FTraceDelegate AsyncTraceDelegate;
 
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	FVector BoxTraceExtent = FVector(5.f);
@@ -45,6 +68,30 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	bool bShowBoxDebug = false;
 
+	/* 
+	* Swing sweep 
+	*/
+	// Sweeps the blade between frames while collision is on, instead of tracing once per overlap
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
+	bool bSweepSwing = true;
+
+	// Biggest blade rotation covered by one sweep, faster swings are split into more sweeps
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (EditCondition = "bSweepSwing", ClampMin = "1.0"))
+	float SweepMaxAngleStep = 15.f;
+
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (EditCondition = "bSweepSwing", ClampMin = "1"))
+	int32 MaxSweepsPerFrame = 4;
+
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (EditCondition = "bSweepSwing", ClampMin = "1"))
+	int32 MaxTracesPerSwing = 32;
+
+	bool bSwingActive = false;
+	bool bHasPrevBlade = false;
+	FVector PrevBladeStart;
+	FVector PrevBladeEnd;
+	int32 NumSwingTraces = 0;
+	int32 NumLastSwingTraces = 0;
+
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	USoundBase* EquipSound;
 
@@ -62,4 +109,7 @@ private:
 
 public:
 	FORCEINLINE UBoxComponent* GetWeaponBox() const { return WeaponBox; }
+	FORCEINLINE int32 GetNumSwingTraces() const { return NumSwingTraces; }
+	FORCEINLINE int32 GetNumLastSwingTraces() const { return NumLastSwingTraces; }
+	FORCEINLINE const FWeaponHitSet& GetHitSet() const { return HitSet; }
 };
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+
+/**
+* Everything a weapon has hit this swing. Membership is a hash lookup into
+* storage that lives inside the weapon, and the collision params the traces
+* use are kept up to date as hits come in, so nothing gets rebuilt or copied
+* per trace. Past InlineCapacity hits it spills to the heap rather than
+* forgetting who it hit.
+* Pointers are only compared, never followed, so an actor dying mid swing is fine
+*/
+struct FWeaponHitSet {
+	static constexpr int32 InlineCapacity = 32;
+
+	FWeaponHitSet()
+		: QueryParams(SCENE_QUERY_STAT(WeaponTrace), false) {}
+
+	// Starts a new swing, the weapon and its wielder are never hit
+	void Reset(const AActor* Weapon, const AActor* Wielder) {
+		HitActors.Reset();
+		QueryParams.ClearIgnoredActors();
+		QueryParams.AddIgnoredActor(Weapon);
+		QueryParams.AddIgnoredActor(Wielder);
+	}
+
+	// False when the actor was already hit this swing
+	bool Add(AActor* Actor) {
+		if (Actor == nullptr) { return false; }
+		bool bAlreadyHit = false;
+		HitActors.Add(Actor, &bAlreadyHit);
+		if (bAlreadyHit) { return false; }
+		QueryParams.AddIgnoredActor(Actor);
+		return true;
+	}
+
+	FORCEINLINE bool Contains(const AActor* Actor) const { return HitActors.Contains(Actor); }
+	FORCEINLINE int32 Num() const { return HitActors.Num(); }
+	FORCEINLINE const FCollisionQueryParams& GetQueryParams() const { return QueryParams; }
+
+private:
+	TSet<const AActor*, DefaultKeyFuncs<const AActor*>, TInlineSetAllocator<InlineCapacity>> HitActors;
+	FCollisionQueryParams QueryParams;
+};
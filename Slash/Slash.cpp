@@ -1,6 +1,17 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Slash.h"
+#include "Slash/SlashStats.h"
 #include "Modules/ModuleManager.h"
 
+#if SLASH_INSTRUMENTATION
+UE_TRACE_CHANNEL_DEFINE(SlashChannel);
+CSV_DEFINE_CATEGORY_MODULE(SLASH_API, Slash, true);
+CSV_DEFINE_CATEGORY_MODULE(SLASH_API, SlashCombat, true);
+#endif
+
+bool FSlashBenchmarkTimers::bRecording = false;
+int32 FSlashBenchmarkTimers::ScopeDepth = 0;
+uint64 FSlashBenchmarkTimers::Cycles[(uint8)ESlashBenchmarkCategory::ESBC_MAX] = {};
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Slash, "Slash" );
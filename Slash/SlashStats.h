@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Trace/Trace.h"
+
+// Hot paths across the whole module, 'stat Slash' in the console
+DECLARE_STATS_GROUP(TEXT("Slash"), STATGROUP_Slash, STATCAT_Advanced);
+
+// Buckets the enemy scaling benchmark reports game thread time in
+enum class ESlashBenchmarkCategory : uint8 {
+	ESBC_AI,
+	// UEnemyMoveScheduler's batch of path requests
+	ESBC_MoveScheduler,
+	// Enemy character movement ticks
+	ESBC_Movement,
+	ESBC_Combat,
+	ESBC_MAX
+};
+
+/* Game thread cycles per category, only collected while a benchmark is recording */
+struct SLASH_API FSlashBenchmarkTimers {
+	static bool bRecording;
+	static int32 ScopeDepth;
+	static uint64 Cycles[(uint8)ESlashBenchmarkCategory::ESBC_MAX];
+
+	static void Reset() { FMemory::Memzero(Cycles); }
+};
+
+/* Only the outermost scope counts, so combat work done inside the AI tick isn't counted twice */
+struct FSlashBenchmarkScope {
+	explicit FSlashBenchmarkScope(ESlashBenchmarkCategory InCategory) : Category(InCategory) {
+		if (!FSlashBenchmarkTimers::bRecording) { return; }
+		bEntered = true;
+		bOutermost = FSlashBenchmarkTimers::ScopeDepth++ == 0;
+		StartCycles = FPlatformTime::Cycles64();
+	}
+	~FSlashBenchmarkScope() {
+		if (!bEntered) { return; }
+		--FSlashBenchmarkTimers::ScopeDepth;
+		if (bOutermost) {
+			FSlashBenchmarkTimers::Cycles[(uint8)Category] += FPlatformTime::Cycles64() - StartCycles;
+		}
+	}
+
+private:
+	ESlashBenchmarkCategory Category;
+	bool bEntered = false;
+	bool bOutermost = false;
+	uint64 StartCycles = 0;
+};
+
+// Nothing below makes it into a shipping build
+#define SLASH_INSTRUMENTATION (!UE_BUILD_SHIPPING)
+
+#if SLASH_INSTRUMENTATION
+
+// '-trace=default,slash' to record it, carries the hot path scopes and the combat timeline
+UE_TRACE_CHANNEL_EXTERN(SlashChannel, SLASH_API);
+
+// 'csvprofile start', Slash has the hot path timings and counters, SlashCombat the combat timeline
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SLASH_API, Slash);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SLASH_API, SlashCombat);
+
+// Times a scope as STAT_Slash<Name> (declare it in the .cpp), a CSV timing and an Insights scope
+#define SLASH_SCOPE_HOT_PATH(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_Slash##Name); \
+	CSV_SCOPED_TIMING_STAT(Slash, Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Slash##Name, SlashChannel)
+
+// Adds to the per frame counter STAT_Slash<Name> and its CSV column
+#define SLASH_COUNT(Name, Amount) \
+	INC_DWORD_STAT_BY(STAT_Slash##Name, Amount); \
+	CSV_CUSTOM_STAT(Slash, Name, (int32)(Amount), ECsvCustomStatOp::Accumulate)
+
+// Sets the per frame counter STAT_Slash<Name> and its CSV column
+#define SLASH_SET_COUNT(Name, Value) \
+	SET_DWORD_STAT(STAT_Slash##Name, Value); \
+	CSV_CUSTOM_STAT(Slash, Name, (int32)(Value), ECsvCustomStatOp::Set)
+
+// Sets the float stat STAT_Slash<Name> and its CSV column to a time in milliseconds
+#define SLASH_SET_MS(Name, Ms) \
+	SET_FLOAT_STAT(STAT_Slash##Name, Ms); \
+	CSV_CUSTOM_STAT(Slash, Name, (float)(Ms), ECsvCustomStatOp::Set)
+
+// A point on the combat timeline (AttackStart, AttackEnd, Hit, Death), an Insights bookmark and a CSV event
+#define SLASH_COMBAT_EVENT(EventName, Actor) \
+	do { \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(SlashChannel)) { \
+			TRACE_BOOKMARK(TEXT("Slash %s %s"), TEXT(#EventName), *GetNameSafe(Actor)); \
+		} \
+		CSV_EVENT(SlashCombat, TEXT("%s %s"), TEXT(#EventName), *GetNameSafe(Actor)); \
+	} while (0)
+
+// Charges the scope to a benchmark category, costs a branch when no benchmark is recording
+#define SLASH_BENCHMARK_SCOPE(Category) FSlashBenchmarkScope ANONYMOUS_VARIABLE(SlashBenchmarkScope)(ESlashBenchmarkCategory::Category)
+
+#else
+
+#define SLASH_SCOPE_HOT_PATH(Name)
+#define SLASH_COUNT(Name, Amount)
+#define SLASH_SET_COUNT(Name, Value)
+#define SLASH_SET_MS(Name, Ms)
+#define SLASH_COMBAT_EVENT(EventName, Actor)
+#define SLASH_BENCHMARK_SCOPE(Category)
+
+#endif